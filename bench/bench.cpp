@@ -0,0 +1,494 @@
+#include "database.h"
+#include "sort.h"
+#include "search.h"
+#include "queue.h"
+#include "tree.h"
+#include "shannon.h"
+#include "generator.h"
+#include "render.h"
+#include "textcache.h"
+#include "transcode.h"
+#include "indexes.h"
+#include "append.h"
+#include "columns.h"
+#include "simdscan.h"
+#include "textsearch.h"
+#include "treefile.h"
+#include "bitmap.h"
+#include "aggregate.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iterator>
+#include <random>
+#include <set>
+#include <sstream>
+
+struct BenchOptions {
+    std::string baseFile = "testBase1.dat";
+    std::string tmpDir = "/tmp";
+    std::string outFile;
+    std::string source = "sample";
+    std::vector<int> sizes = {1000, 4000, 16000};
+    int reps = 5;
+    unsigned seed = 42;
+};
+
+struct BenchResult {
+    std::string name;
+    int size;
+    int reps;
+    long long ops;
+    std::vector<double> samples;
+};
+
+struct BenchDataset {
+    std::string filename;
+    std::vector<Record> db;
+    std::vector<Record*> unsorted;
+    std::vector<Record*> sorted;
+    std::vector<std::string> prefixes;
+};
+
+double elapsedNs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+BenchResult runBenchmark(const std::string& name, int size, int reps, long long ops,
+                         const std::function<void()>& setup,
+                         const std::function<void()>& body) {
+    BenchResult result{name, size, reps, ops, {}};
+    for (int r = 0; r < reps; ++r) {
+        if (setup) setup();
+        auto start = std::chrono::steady_clock::now();
+        body();
+        result.samples.push_back(elapsedNs(start));
+    }
+    return result;
+}
+
+std::vector<int> parseSizes(const std::string& text) {
+    std::vector<int> sizes;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) sizes.push_back(std::stoi(item));
+    }
+    return sizes;
+}
+
+bool parseBenchArgs(int argc, char** argv, BenchOptions& opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Не указано значение для " << arg << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--base") opts.baseFile = value;
+        else if (arg == "--tmp") opts.tmpDir = value;
+        else if (arg == "--out") opts.outFile = value;
+        else if (arg == "--source") opts.source = value;
+        else if (arg == "--sizes") opts.sizes = parseSizes(value);
+        else if (arg == "--reps") opts.reps = std::max(1, std::stoi(value));
+        else if (arg == "--seed") opts.seed = static_cast<unsigned>(std::stoul(value));
+        else {
+            std::cerr << "Неизвестный параметр: " << arg << std::endl;
+            return false;
+        }
+    }
+    return !opts.sizes.empty();
+}
+
+bool writeDataset(const std::string& filename, const std::vector<Record>& base, int size, unsigned seed) {
+    std::ofstream out(filename, std::ios::binary);
+    if (!out) return false;
+    std::mt19937 gen(seed + size);
+    std::uniform_int_distribution<size_t> dis(0, base.size() - 1);
+    for (int i = 0; i < size; ++i) {
+        const Record& rec = base[dis(gen)];
+        out.write(reinterpret_cast<const char*>(&rec), sizeof(Record));
+    }
+    return static_cast<bool>(out);
+}
+
+bool prepareDataset(const BenchOptions& opts, const std::vector<Record>& base, int size, BenchDataset& ds) {
+    ds.filename = opts.tmpDir + "/coursework_bench_" + std::to_string(size) + ".dat";
+    if (opts.source == "sample") {
+        if (!writeDataset(ds.filename, base, size, opts.seed)) return false;
+    } else {
+        GeneratorOptions gen;
+        gen.count = size;
+        gen.seed = opts.seed + size;
+        if (!parseGeneratorOrder(opts.source, gen.order)) return false;
+        if (!writeGeneratedDatabase(ds.filename, gen)) return false;
+    }
+
+    ds.db = loadDatabase(ds.filename);
+    for (auto& rec : ds.db) ds.unsorted.push_back(&rec);
+    ds.sorted = ds.unsorted;
+    quickSortHoare(ds.sorted, 0, ds.sorted.size() - 1);
+
+    std::set<std::string> unique;
+    for (Record* rec : ds.sorted) unique.insert(getSurnamePrefix(*rec));
+    ds.prefixes.assign(unique.begin(), unique.end());
+    return true;
+}
+
+std::string largestPrefix(const BenchDataset& ds) {
+    std::string best;
+    int bestSize = -1;
+    for (const std::string& prefix : ds.prefixes) {
+        Queue q = binarySearchWithIndexing(ds.sorted, prefix);
+        if (q.size > bestSize) {
+            bestSize = q.size;
+            best = prefix;
+        }
+        clearQueue(q);
+    }
+    return best;
+}
+
+void benchDataset(const BenchOptions& opts, BenchDataset& ds, std::vector<BenchResult>& results) {
+    int n = ds.db.size();
+    std::vector<Record*> work;
+
+    results.push_back(runBenchmark("load", n, opts.reps, 1, nullptr, [&] {
+        std::vector<Record> db = loadDatabase(ds.filename);
+    }));
+
+    results.push_back(runBenchmark("quick_sort_hoare", n, opts.reps, 1,
+        [&] { work = ds.unsorted; },
+        [&] { quickSortHoare(work, 0, work.size() - 1); }));
+
+    results.push_back(runBenchmark("quick_sort_hoare_presorted", n, opts.reps, 1,
+        [&] { work = ds.sorted; },
+        [&] { quickSortHoare(work, 0, work.size() - 1); }));
+
+    const std::pair<const char*, SortOrder> orders[] = {
+        {"sort_by_surname", SORT_SURNAME},
+        {"sort_by_surname_year", SORT_SURNAME_YEAR},
+        {"sort_by_publisher_pages", SORT_PUBLISHER_PAGES},
+        {"sort_by_year_pages", SORT_YEAR_PAGES}
+    };
+    for (const auto& order : orders) {
+        results.push_back(runBenchmark(order.first, n, opts.reps, 1,
+            [&] { work = ds.unsorted; },
+            [&] { sortRecords(work, order.second); }));
+    }
+
+    results.push_back(runBenchmark("adaptive_sort", n, opts.reps, 1,
+        [&] { work = ds.unsorted; },
+        [&] { adaptiveSortBy<SurnameKey>(work); }));
+
+    results.push_back(runBenchmark("adaptive_sort_presorted", n, opts.reps, 1,
+        [&] { work = ds.sorted; },
+        [&] { adaptiveSortBy<SurnameKey>(work); }));
+
+    std::vector<Record*> reversed(ds.sorted.rbegin(), ds.sorted.rend());
+    results.push_back(runBenchmark("adaptive_sort_reversed", n, opts.reps, 1,
+        [&] { work = reversed; },
+        [&] { adaptiveSortBy<SurnameKey>(work); }));
+
+    IncrementalSort lazy;
+    results.push_back(runBenchmark("incremental_first_page", n, opts.reps, 1,
+        [&] { initIncrementalSort(lazy, ds.unsorted); },
+        [&] { ensureSortedRange(lazy, 0, 20); }));
+
+    results.push_back(runBenchmark("incremental_ten_pages", n, opts.reps, 10,
+        [&] { initIncrementalSort(lazy, ds.unsorted); },
+        [&] { for (int page = 0; page < 10; ++page) ensureSortedRange(lazy, page * 20, (page + 1) * 20); }));
+
+    int tail = std::max(1, n / 100);
+    std::vector<Record*> head, batch;
+    for (Record* rec : ds.sorted) {
+        (rec - ds.db.data() >= n - tail ? batch : head).push_back(rec);
+    }
+    quickSortHoare(batch, 0, batch.size() - 1);
+    std::vector<Record*> appended = head;
+    appended.insert(appended.end(), batch.begin(), batch.end());
+    results.push_back(runBenchmark("sort_by_surname_appended_1pct", n, opts.reps, 1,
+        [&] { work = appended; },
+        [&] { sortRecords(work, SORT_SURNAME); }));
+    results.push_back(runBenchmark("adaptive_sort_appended_1pct", n, opts.reps, 1,
+        [&] { work = appended; },
+        [&] { adaptiveSortBy<SurnameKey>(work); }));
+    results.push_back(runBenchmark("append_merge_1pct", n, opts.reps, batch.size(),
+        [&] { work = head; },
+        [&] { mergeSortedBatch(work, batch); }));
+
+    results.push_back(runBenchmark("binary_search", n, opts.reps, ds.prefixes.size(), nullptr, [&] {
+        for (const std::string& prefix : ds.prefixes) {
+            Queue q = binarySearchWithIndexing(ds.sorted, prefix);
+            clearQueue(q);
+        }
+    }));
+
+    Queue treeQueue = binarySearchWithIndexing(ds.sorted, largestPrefix(ds));
+
+    results.push_back(runBenchmark("build_tree_a1", treeQueue.size, opts.reps, 1, nullptr, [&] {
+        OptimalSearchTree* tree = buildOptimalSearchTreeA1(treeQueue);
+        clearOptimalTree(tree);
+    }));
+
+    OptimalSearchTree* tree = buildOptimalSearchTreeA1(treeQueue);
+    std::vector<int> pagesQueries;
+    for (QueueNode* node = treeQueue.front; node != nullptr; node = node->next) {
+        pagesQueries.push_back(node->data->pages);
+    }
+    pagesQueries.push_back(-1);
+
+    results.push_back(runBenchmark("pages_one_off_tree", treeQueue.size, opts.reps, 1, nullptr, [&] {
+        OptimalSearchTree* oneOff = buildOptimalSearchTreeA1(treeQueue);
+        std::vector<Record*> found = searchInTreeByPages(oneOff, pagesQueries.front());
+        clearOptimalTree(oneOff);
+    }));
+
+    results.push_back(runBenchmark("search_tree_by_pages", treeQueue.size, opts.reps, pagesQueries.size(), nullptr, [&] {
+        for (int pages : pagesQueries) {
+            std::vector<Record*> found = searchInTreeByPages(tree, pages);
+        }
+    }));
+
+    results.push_back(runBenchmark("search_tree_by_pages_batch", treeQueue.size, opts.reps, pagesQueries.size(), nullptr, [&] {
+        std::vector<TreeLookup> found = searchInTreeByPagesBatch(tree, pagesQueries);
+    }));
+
+    std::string treeFile = ds.filename + ".tree";
+    saveOptimalTree(tree, ds.db, treeFile);
+    results.push_back(runBenchmark("pages_mapped_tree", treeQueue.size, opts.reps, 1, nullptr, [&] {
+        MappedTree mapped;
+        if (openMappedTree(mapped, treeFile, ds.db)) {
+            std::vector<Record*> found = searchMappedTreeByPages(mapped, ds.db, pagesQueries.front());
+        }
+        closeMappedTree(mapped);
+    }));
+
+    MappedTree mapped;
+    openMappedTree(mapped, treeFile, ds.db);
+    results.push_back(runBenchmark("search_mapped_tree_by_pages", treeQueue.size, opts.reps, pagesQueries.size(), nullptr, [&] {
+        for (int pages : pagesQueries) {
+            std::vector<Record*> found = searchMappedTreeByPages(mapped, ds.db, pages);
+        }
+    }));
+    results.push_back(runBenchmark("search_mapped_tree_by_pages_batch", treeQueue.size, opts.reps, pagesQueries.size(), nullptr, [&] {
+        std::vector<MappedTreeLookup> found = searchMappedTreeByPagesBatch(mapped, pagesQueries);
+    }));
+    closeMappedTree(mapped);
+    std::remove(treeFile.c_str());
+
+    clearOptimalTree(tree);
+    clearQueue(treeQueue);
+
+    std::string screen;
+    int rows = std::min(n, 200);
+    attachRecordTextCache(ds.db);
+    results.push_back(runBenchmark("render_rows_cold", rows, opts.reps, rows,
+        [&] { clearRecordTextCache(); },
+        [&] {
+            screen.clear();
+            for (int i = 0; i < rows; ++i) appendRecordRow(screen, ds.sorted[i]);
+        }));
+
+    results.push_back(runBenchmark("render_rows_cached", rows, opts.reps, rows, nullptr, [&] {
+        screen.clear();
+        for (int i = 0; i < rows; ++i) appendRecordRow(screen, ds.sorted[i]);
+    }));
+    clearRecordTextCache();
+
+    results.push_back(runBenchmark("build_secondary_indexes", n, opts.reps, 1, nullptr, [&] {
+        SecondaryIndexes indexes;
+        initSecondaryIndexes(indexes, ds.db);
+        buildAllSecondaryIndexes(indexes);
+    }));
+
+    SecondaryIndexes indexes;
+    initSecondaryIndexes(indexes, ds.db);
+    buildAllSecondaryIndexes(indexes);
+    results.push_back(runBenchmark("index_year_lookup", n, opts.reps, 200, nullptr, [&] {
+        for (int year = 1900; year < 2100; ++year) {
+            std::vector<Record*> found = lookupRange(indexes, FIELD_YEAR, year, year);
+        }
+    }));
+
+    ColumnStore store;
+    initColumnStore(store, ds.db);
+    const ColumnStore& columns = columnStore(store);
+    std::vector<uint32_t> selected;
+    long long checksum = 0;
+
+    results.push_back(runBenchmark("scan_pages_records", n, opts.reps, n, nullptr, [&] {
+        selected.clear();
+        for (size_t i = 0; i < ds.db.size(); ++i) {
+            if (ds.db[i].pages >= 200 && ds.db[i].pages <= 400) selected.push_back(static_cast<uint32_t>(i));
+        }
+    }));
+
+    results.push_back(runBenchmark("scan_pages_columns", n, opts.reps, n, nullptr, [&] {
+        scanRange(columns, FIELD_PAGES, 200, 400, selected);
+    }));
+
+    std::string publisher(ds.db[0].publisher, sizeof(ds.db[0].publisher));
+    publisher.resize(publisher.find_last_not_of(std::string(" \0", 2)) + 1);
+    std::vector<uint64_t> bitmap;
+    size_t width = PUBLISHER_WIDTH;
+    std::vector<char> publisherText(ds.db.size() * width + SCAN_PADDING, '\0');
+    for (size_t i = 0; i < ds.db.size(); ++i) memcpy(&publisherText[i * width], ds.db[i].publisher, width);
+    const char* publisherColumn = publisherText.data();
+    ScanIsa detected = detectScanIsa();
+    for (int isa = SCAN_SCALAR; isa <= detected; ++isa) {
+        setScanIsa(static_cast<ScanIsa>(isa));
+        std::string suffix = std::string("_") + scanIsaName(static_cast<ScanIsa>(isa));
+        results.push_back(runBenchmark("scan_pages_eq" + suffix, n, opts.reps, n, nullptr, [&] {
+            filterRangeBitmap(columns.pages.data(), columns.rows, ds.db[0].pages, ds.db[0].pages, bitmap);
+        }));
+        results.push_back(runBenchmark("scan_publisher_eq" + suffix, n, opts.reps, n, nullptr, [&] {
+            filterTextBitmap(publisherColumn, width, columns.rows, publisher.data(), publisher.size(), false, bitmap);
+        }));
+    }
+    setScanIsa(detected);
+
+    results.push_back(runBenchmark("scan_publisher_eq_dictionary", n, opts.reps, n, nullptr, [&] {
+        scanTextBitmap(columns, FIELD_PUBLISHER, recordFieldText(ds.db[0].publisher, width), false, bitmap);
+    }));
+
+    std::vector<Record*> byAuthor = lookupPrefix(indexes, FIELD_AUTHOR, extractSurname(*ds.sorted[n / 2]).substr(0, 2));
+    std::vector<Record*> byYear = lookupRange(indexes, FIELD_YEAR, 1950, 1990);
+    std::vector<Record*> byPages = lookupRange(indexes, FIELD_PAGES, 200, 400);
+    results.push_back(runBenchmark("combine_lists", n, opts.reps, 1, nullptr, [&] {
+        std::vector<Record*> a = byAuthor, b = byYear, c = byPages, ab, abc;
+        std::sort(a.begin(), a.end());
+        std::sort(b.begin(), b.end());
+        std::sort(c.begin(), c.end());
+        std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(ab));
+        std::set_intersection(ab.begin(), ab.end(), c.begin(), c.end(), std::back_inserter(abc));
+        checksum += abc.size();
+    }));
+
+    RecordBitmap authorBitmap = recordBitmapFromRecords(ds.db, byAuthor);
+    std::vector<uint64_t> yearWords, pagesWords;
+    scanRangeBitmap(columns, FIELD_YEAR, 1950, 1990, yearWords);
+    scanRangeBitmap(columns, FIELD_PAGES, 200, 400, pagesWords);
+    RecordBitmap yearBitmap = recordBitmapFromWords(yearWords, columns.rows);
+    RecordBitmap pagesBitmap = recordBitmapFromWords(pagesWords, columns.rows);
+    results.push_back(runBenchmark("combine_bitmaps", n, opts.reps, 1, nullptr, [&] {
+        RecordBitmap result = combineRecordBitmaps(combineRecordBitmaps(authorBitmap, yearBitmap, BITMAP_AND),
+                                                   pagesBitmap, BITMAP_AND);
+        checksum += recordBitmapCardinality(result);
+    }));
+
+    TextSearchIndex textSearch;
+    initTextSearchIndex(textSearch, ds.db, ds.sorted);
+    results.push_back(runBenchmark("build_text_search", n, opts.reps, 1, nullptr, [&] {
+        textSearch.rows = 0;
+        buildTextSearchIndex(textSearch);
+    }));
+
+    std::string surname = extractSurname(*ds.sorted[n / 2]);
+    results.push_back(runBenchmark("substring_search", n, opts.reps, 1, nullptr, [&] {
+        Queue q = substringSearch(textSearch, surname);
+        clearQueue(q);
+    }));
+
+    results.push_back(runBenchmark("fuzzy_search", n, opts.reps, 1, nullptr, [&] {
+        Queue q = fuzzySearch(textSearch, surname, defaultFuzzyDistance(surname));
+        clearQueue(q);
+    }));
+
+    results.push_back(runBenchmark("sum_year_columns", n, opts.reps, n, nullptr, [&] {
+        checksum += summarizeColumn(columns, FIELD_YEAR).sum;
+    }));
+
+    const GroupKey groupKeys[] = {GROUP_PUBLISHER, GROUP_AUTHOR, GROUP_YEAR, GROUP_SURNAME};
+    const char* groupNames[] = {"group_publisher", "group_author", "group_year", "group_surname"};
+    for (int g = 0; g < 4; ++g) {
+        results.push_back(runBenchmark(groupNames[g], n, opts.reps, n, nullptr, [&] {
+            checksum += aggregateGroups(columns, groupKeys[g], AGGREGATE_MAX_PREFIX, 0, 0).size();
+        }));
+    }
+    results.push_back(runBenchmark("group_publisher_one_thread", n, opts.reps, n, nullptr, [&] {
+        checksum += aggregateGroups(columns, GROUP_PUBLISHER, AGGREGATE_MAX_PREFIX, 0, 1).size();
+    }));
+
+    std::vector<std::string> column;
+    results.push_back(runBenchmark("transcode_title_column", n, opts.reps, n, nullptr, [&] {
+        transcodeColumn(ds.db, FIELD_TITLE, column);
+    }));
+
+    ShannonCode* code = new ShannonCode;
+    results.push_back(runBenchmark("shannon", n, opts.reps, 1, nullptr, [&] {
+        std::vector<char> buffer;
+        readWholeFile(ds.filename, buffer);
+        buildShannonCode(buffer.data(), buffer.size(), *code);
+    }));
+    delete code;
+}
+
+void writeJson(std::ostream& out, const BenchOptions& opts, const std::vector<BenchResult>& results) {
+    out << "{\n";
+    out << "  \"suite\": \"coursework_bench\",\n";
+    out << "  \"base\": \"" << opts.baseFile << "\",\n";
+    out << "  \"source\": \"" << opts.source << "\",\n";
+    out << "  \"reps\": " << opts.reps << ",\n";
+    out << "  \"seed\": " << opts.seed << ",\n";
+    out << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        std::vector<double> sorted = r.samples;
+        std::sort(sorted.begin(), sorted.end());
+        double sum = 0.0;
+        for (double s : sorted) sum += s;
+        double median = sorted[sorted.size() / 2];
+        double perOp = r.ops > 0 ? median / r.ops : median;
+
+        out << "    {\"name\": \"" << r.name << "\", \"size\": " << r.size
+            << ", \"reps\": " << r.reps << ", \"ops\": " << r.ops
+            << std::fixed << std::setprecision(1)
+            << ", \"min_ns\": " << sorted.front()
+            << ", \"median_ns\": " << median
+            << ", \"mean_ns\": " << sum / sorted.size()
+            << ", \"max_ns\": " << sorted.back()
+            << ", \"median_ns_per_op\": " << perOp << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+int main(int argc, char** argv) {
+    BenchOptions opts;
+    if (!parseBenchArgs(argc, argv, opts)) {
+        std::cerr << "Использование: coursework_bench [--base FILE] [--sizes N,N,...] [--reps N] "
+                     "[--seed N] [--source sample|random|presorted|reversed|nearly|equal] "
+                     "[--tmp DIR] [--out FILE]" << std::endl;
+        return 2;
+    }
+
+    std::vector<Record> base;
+    if (opts.source == "sample") base = loadDatabase(opts.baseFile);
+    if (opts.source == "sample" && base.empty()) {
+        std::cerr << "Ошибка: не удалось загрузить базу данных '" << opts.baseFile << "'!" << std::endl;
+        return 1;
+    }
+
+    std::vector<BenchResult> results;
+    for (int size : opts.sizes) {
+        BenchDataset ds;
+        if (!prepareDataset(opts, base, size, ds)) {
+            std::cerr << "Ошибка записи набора данных " << ds.filename << std::endl;
+            return 1;
+        }
+        std::cerr << "Набор " << size << " записей..." << std::endl;
+        benchDataset(opts, ds, results);
+        std::remove(ds.filename.c_str());
+    }
+
+    if (opts.outFile.empty()) {
+        writeJson(std::cout, opts, results);
+    } else {
+        std::ofstream out(opts.outFile);
+        writeJson(out, opts, results);
+    }
+    return 0;
+}
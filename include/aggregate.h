@@ -0,0 +1,29 @@
+#ifndef AGGREGATE_H
+#define AGGREGATE_H
+
+#include "database.h"
+#include "columns.h"
+#include <string>
+#include <vector>
+
+#define AGGREGATE_MIN_ROWS_PER_THREAD 65536
+#define AGGREGATE_MAX_PREFIX 3
+
+enum GroupKey {
+    GROUP_AUTHOR,
+    GROUP_PUBLISHER,
+    GROUP_YEAR,
+    GROUP_SURNAME
+};
+
+struct GroupAggregate {
+    std::string value;
+    ColumnSummary pages;
+};
+
+bool parseGroupKey(const std::string& name, GroupKey& key, int& prefixLetters);
+std::vector<GroupAggregate> aggregateGroups(const ColumnStore& store, GroupKey key, int prefixLetters, size_t limit,
+                                            int threads);
+double averagePages(const ColumnSummary& summary);
+
+#endif
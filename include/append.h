@@ -0,0 +1,19 @@
+#ifndef APPEND_H
+#define APPEND_H
+
+#include "database.h"
+#include "indexes.h"
+#include "prefixcache.h"
+#include <vector>
+#include <string>
+
+bool appendRecordsToFile(const std::string& filename, const std::vector<Record>& batch);
+void mergeSortedBatch(std::vector<Record*>& sorted, const std::vector<Record*>& batch);
+bool appendRecords(const std::string& filename,
+                   std::vector<Record>& db,
+                   std::vector<Record*>& sorted,
+                   SecondaryIndexes& indexes,
+                   PrefixCache* prefixCache,
+                   const std::vector<Record>& batch);
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "database.h"
+#include "tree.h"
+#include "shannon.h"
+#include "indexes.h"
+#include "sort.h"
+#include "prefixcache.h"
+#include "columns.h"
+#include "textsearch.h"
+#include "treefile.h"
+#include "bitmap.h"
+#include "aggregate.h"
+#include <map>
+#include <mutex>
+#include <vector>
+#include <string>
+#include <iostream>
+
+#define BATCH_PREFIX_SHARDS 8
+
+enum BatchFormat {
+    BATCH_TSV,
+    BATCH_JSON
+};
+
+struct PrefixCacheShard {
+    std::mutex mutex;
+    PrefixCache cache;
+};
+
+struct BatchShared {
+    std::vector<PrefixCacheShard> prefixShards;
+    std::mutex orderingsMutex;
+    std::map<SortOrder, std::vector<Record*>> orderings;
+    std::mutex shannonMutex;
+    ShannonCode* shannon;
+};
+
+struct BatchContext {
+    const std::vector<Record>* db;
+    const std::vector<Record*>* indices;
+    SecondaryIndexes* indexes;
+    ColumnStore* columns;
+    TextSearchIndex* textSearch;
+    std::vector<std::string> dbFiles;
+    BatchFormat format;
+    int threads;
+    bool fileCommands;
+    BatchShared* shared;
+    std::map<std::string, MappedTree> mappedTrees;
+};
+
+void initBatchShared(BatchShared& shared, size_t prefixShards);
+void clearBatchShared(BatchShared& shared);
+void writeBatchSharedStats(BatchShared& shared, std::ostream& out);
+void initBatchContext(BatchContext& ctx, const std::vector<Record>& db, const std::vector<Record*>& indices,
+                      SecondaryIndexes& indexes, ColumnStore& columns, TextSearchIndex& textSearch,
+                      BatchShared& shared, const std::vector<std::string>& dbFiles, BatchFormat format);
+void clearBatchContext(BatchContext& ctx);
+bool parseBatchFormat(const std::string& name, BatchFormat& format);
+void executeBatchQuery(BatchContext& ctx, const std::string& line, long long id, std::string& out);
+long long runBatch(BatchContext& ctx, std::istream& in, std::ostream& out);
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef BITMAP_H
+#define BITMAP_H
+
+#include "database.h"
+#include <cstdint>
+#include <vector>
+
+#define BITMAP_ARRAY_LIMIT 4096
+#define BITMAP_CONTAINER_WORDS 1024
+
+struct BitmapContainer {
+    uint16_t key;
+    uint32_t cardinality;
+    std::vector<uint16_t> array;
+    std::vector<uint64_t> words;
+};
+
+struct RecordBitmap {
+    std::vector<BitmapContainer> containers;
+};
+
+enum BitmapOp {
+    BITMAP_AND,
+    BITMAP_OR,
+    BITMAP_ANDNOT
+};
+
+RecordBitmap recordBitmapFromRows(const std::vector<uint32_t>& rows);
+RecordBitmap recordBitmapFromRecords(const std::vector<Record>& db, const std::vector<Record*>& records);
+RecordBitmap recordBitmapFromWords(const std::vector<uint64_t>& words, size_t rows);
+RecordBitmap combineRecordBitmaps(const RecordBitmap& a, const RecordBitmap& b, BitmapOp op);
+size_t recordBitmapCardinality(const RecordBitmap& bitmap);
+bool recordBitmapContains(const RecordBitmap& bitmap, uint32_t row);
+void recordBitmapRows(const RecordBitmap& bitmap, std::vector<uint32_t>& rows);
+std::vector<Record*> recordBitmapRecords(const std::vector<Record>& db, const RecordBitmap& bitmap);
+
+#endif
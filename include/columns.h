@@ -0,0 +1,62 @@
+#ifndef COLUMNS_H
+#define COLUMNS_H
+
+#include "database.h"
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include <string>
+
+#define AUTHOR_WIDTH 12
+#define TITLE_WIDTH 32
+#define PUBLISHER_WIDTH 16
+#define DICTIONARY_MAX_CODES 32767
+
+struct DictionaryColumn {
+    bool encoded;
+    size_t width;
+    size_t size;
+    std::vector<char> values;
+    std::vector<int16_t> codes;
+};
+
+struct ColumnStore {
+    const std::vector<Record>* db;
+    std::once_flag built;
+    size_t rows;
+    std::vector<int16_t> year;
+    std::vector<int16_t> pages;
+    std::vector<char> author;
+    std::vector<char> title;
+    std::vector<char> publisher;
+    DictionaryColumn authorDict;
+    DictionaryColumn publisherDict;
+};
+
+struct ColumnSummary {
+    size_t count;
+    long long sum;
+    int min;
+    int max;
+};
+
+void initColumnStore(ColumnStore& store, const std::vector<Record>& db);
+const ColumnStore& columnStore(ColumnStore& store);
+const int16_t* numericColumn(const ColumnStore& store, RecordField field);
+const char* textColumn(const ColumnStore& store, RecordField field, size_t& width);
+const DictionaryColumn* dictionaryColumn(const ColumnStore& store, RecordField field);
+std::string dictionaryValue(const DictionaryColumn& dict, int code);
+void countDictionaryCodes(const ColumnStore& store, RecordField field, std::vector<size_t>& counts);
+size_t columnStoreBytes(const ColumnStore& store);
+
+void scanRangeBitmap(const ColumnStore& store, RecordField field, int low, int high, std::vector<uint64_t>& bitmap);
+void scanTextBitmap(const ColumnStore& store, RecordField field, const std::string& value, bool prefix,
+                    std::vector<uint64_t>& bitmap);
+void scanRange(const ColumnStore& store, RecordField field, int low, int high, std::vector<uint32_t>& rows);
+void scanText(const ColumnStore& store, RecordField field, const std::string& value, bool prefix,
+              std::vector<uint32_t>& rows);
+ColumnSummary summarizeColumn(const ColumnStore& store, RecordField field);
+ColumnSummary summarizeRows(const ColumnStore& store, RecordField field, const std::vector<uint32_t>& rows);
+std::vector<Record*> rowsToRecords(const ColumnStore& store, const std::vector<uint32_t>& rows);
+
+#endif
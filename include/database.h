@@ -6,7 +6,6 @@
 #include <fstream>
 #include <iostream>
 #include <iomanip>
-#include <iconv.h>
 #include <cstring>
 #include <locale>
 
@@ -18,9 +17,21 @@ struct Record {
     short pages;
 };
 
+enum RecordField {
+    FIELD_AUTHOR,
+    FIELD_TITLE,
+    FIELD_PUBLISHER,
+    FIELD_YEAR,
+    FIELD_PAGES
+};
+
 std::vector<Record> loadDatabase(const std::string& filename);
 std::string convertToUTF8(const char* src, size_t len);
+std::string recordFieldText(const char* src, size_t len);
 std::string extractSurname(const Record& rec);
+const char* surnameBytes(const Record& rec, size_t& len);
+const char* recordFieldBytes(const Record& rec, RecordField field, size_t& len);
+int recordFieldNumber(const Record& rec, RecordField field);
 int customCompare(const std::string& a, const std::string& b);
 
 #endif
\ No newline at end of file
@@ -4,15 +4,27 @@
 #include "database.h"
 #include "queue.h"
 #include "tree.h"
+#include "indexes.h"
+#include "prefixcache.h"
+#include "textsearch.h"
+#include "columns.h"
+#include "sort.h"
+#include <future>
 #include <vector>
 #include <string>
 
 void displayPage(const std::vector<Record*>& data, int page, int per_page, const std::string& title, bool show_special_options);
-void displayInteractive(const std::vector<Record*>& data, const std::string& title, bool is_sorted_view);
-void displayQueueWithTreeOption(const Queue& q, const std::string& title, OptimalSearchTree*& optimalTree);
+void displayInteractive(const std::vector<Record*>& data, const std::string& title, bool is_sorted_view,
+                        IncrementalSort* lazy = nullptr);
+void displayQueueWithTreeOption(PrefixCache& cache, PrefixCacheEntry& entry, const std::string& title);
+void waitForSortedIndex(const std::shared_future<void>& sortedReady);
 void displayMainMenu(const std::vector<Record>& original, 
                      const std::vector<Record*>& sorted_indices,
-                     Queue*& currentQueue,
-                     OptimalSearchTree*& optimalTree);
+                     const std::shared_future<void>& sortedReady,
+                     SecondaryIndexes& indexes,
+                     TextSearchIndex& textSearch,
+                     ColumnStore& columns,
+                     PrefixCache& prefixCache,
+                     const std::vector<std::string>& dbFiles);
 
 #endif
\ No newline at end of file
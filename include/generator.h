@@ -0,0 +1,28 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include "database.h"
+#include <vector>
+#include <string>
+
+enum GeneratorOrder {
+    ORDER_RANDOM,
+    ORDER_PRESORTED,
+    ORDER_REVERSED,
+    ORDER_NEARLY_SORTED,
+    ORDER_EQUAL_SURNAMES
+};
+
+struct GeneratorOptions {
+    long long count = 4000;
+    unsigned seed = 1;
+    GeneratorOrder order = ORDER_RANDOM;
+    double surnameSkew = 1.0;
+    double unsortedTail = 0.05;
+};
+
+bool parseGeneratorOrder(const std::string& name, GeneratorOrder& order);
+std::vector<Record> generateRecords(const GeneratorOptions& opts);
+bool writeGeneratedDatabase(const std::string& filename, const GeneratorOptions& opts);
+
+#endif
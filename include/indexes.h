@@ -0,0 +1,29 @@
+#ifndef INDEXES_H
+#define INDEXES_H
+
+#include "database.h"
+#include <vector>
+#include <string>
+#include <mutex>
+
+#define SECONDARY_INDEX_COUNT 5
+
+struct SecondaryIndexes {
+    const std::vector<Record>* db;
+    std::vector<Record*> byField[SECONDARY_INDEX_COUNT];
+    std::once_flag built[SECONDARY_INDEX_COUNT];
+    bool ready[SECONDARY_INDEX_COUNT];
+};
+
+void initSecondaryIndexes(SecondaryIndexes& indexes, const std::vector<Record>& db);
+const std::vector<Record*>& secondaryIndex(SecondaryIndexes& indexes, RecordField field);
+void buildAllSecondaryIndexes(SecondaryIndexes& indexes);
+
+bool parseRecordField(const std::string& name, RecordField& field);
+int compareRecordsByField(const Record& a, const Record& b, RecordField field);
+
+std::vector<Record*> lookupEqual(SecondaryIndexes& indexes, RecordField field, const std::string& value);
+std::vector<Record*> lookupPrefix(SecondaryIndexes& indexes, RecordField field, const std::string& prefix);
+std::vector<Record*> lookupRange(SecondaryIndexes& indexes, RecordField field, int low, int high);
+
+#endif
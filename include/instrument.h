@@ -0,0 +1,60 @@
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+#include <iostream>
+
+#ifdef COURSEWORK_INSTRUMENT
+
+#include <atomic>
+#include <chrono>
+
+struct InstrumentCounter {
+    const char* name;
+    bool isTimer;
+    std::atomic<long long> count;
+    std::atomic<long long> totalNs;
+    std::atomic<long long> maxNs;
+};
+
+InstrumentCounter& registerInstrumentCounter(const char* name, bool isTimer);
+
+struct ScopedTimer {
+    InstrumentCounter& counter;
+    std::chrono::steady_clock::time_point start;
+
+    explicit ScopedTimer(InstrumentCounter& c) : counter(c), start(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() {
+        long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        counter.count.fetch_add(1, std::memory_order_relaxed);
+        counter.totalNs.fetch_add(ns, std::memory_order_relaxed);
+        long long prev = counter.maxNs.load(std::memory_order_relaxed);
+        while (ns > prev && !counter.maxNs.compare_exchange_weak(prev, ns, std::memory_order_relaxed)) {}
+    }
+};
+
+#define INSTR_CONCAT_IMPL(a, b) a##b
+#define INSTR_CONCAT(a, b) INSTR_CONCAT_IMPL(a, b)
+
+#define INSTR_COUNT(name) \
+    do { \
+        static InstrumentCounter& instrCounter = registerInstrumentCounter(name, false); \
+        instrCounter.count.fetch_add(1, std::memory_order_relaxed); \
+    } while (0)
+
+#define INSTR_TIMER(name) \
+    static InstrumentCounter& INSTR_CONCAT(instrTimerCounter, __LINE__) = registerInstrumentCounter(name, true); \
+    ScopedTimer INSTR_CONCAT(instrTimer, __LINE__)(INSTR_CONCAT(instrTimerCounter, __LINE__))
+
+#else
+
+#define INSTR_COUNT(name) do {} while (0)
+#define INSTR_TIMER(name) do {} while (0)
+
+#endif
+
+bool instrumentationEnabled();
+void writeInstrumentReport(std::ostream& out);
+void resetInstrumentCounters();
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef PREFIXCACHE_H
+#define PREFIXCACHE_H
+
+#include "database.h"
+#include "queue.h"
+#include "tree.h"
+#include <list>
+#include <unordered_map>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#define PREFIX_CACHE_CAPACITY 64
+
+struct PrefixCacheEntry {
+    std::string prefix;
+    Queue queue;
+    OptimalSearchTree* tree;
+};
+
+struct PrefixCache {
+    size_t capacity;
+    std::list<PrefixCacheEntry> entries;
+    std::unordered_map<std::string, std::list<PrefixCacheEntry>::iterator> lookup;
+    const std::vector<Record*>* source;
+    size_t sourceSize;
+    long long hits;
+    long long misses;
+    long long evictions;
+    long long treeHits;
+    long long treeBuilds;
+};
+
+void initPrefixCache(PrefixCache& cache, size_t capacity);
+void invalidatePrefixCache(PrefixCache& cache);
+void clearPrefixCache(PrefixCache& cache);
+PrefixCacheEntry& cachedPrefixSearch(PrefixCache& cache, const std::vector<Record*>& indices, const std::string& prefix);
+OptimalSearchTree* cachedPrefixTree(PrefixCache& cache, PrefixCacheEntry& entry);
+void writePrefixCacheStats(const PrefixCache& cache, std::ostream& out);
+
+#endif
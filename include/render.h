@@ -0,0 +1,29 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include "database.h"
+#include <string>
+
+#define SCREEN_TEXT_WIDTH 74
+
+enum BorderKind {
+    BORDER_TOP,
+    BORDER_MIDDLE,
+    BORDER_BOTTOM
+};
+
+size_t displayWidth(const std::string& utf8);
+void appendPadded(std::string& out, const std::string& text, size_t width);
+void appendPaddedLeft(std::string& out, const std::string& text, size_t width);
+
+void beginScreen(std::string& screen);
+void appendBorder(std::string& screen, BorderKind kind);
+void appendBoxLine(std::string& screen, const std::string& text);
+void appendCenteredBoxLine(std::string& screen, const std::string& text);
+void appendRecordTableHeader(std::string& screen, const std::string& title);
+void appendRecordRow(std::string& screen, const Record* rec);
+void appendEmptyRows(std::string& screen, int count);
+void flushScreen(std::string& screen);
+void clearScreen();
+
+#endif
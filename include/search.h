@@ -6,6 +6,9 @@
 #include <vector>
 #include <string>
 
+std::string getSurnamePrefix(const Record& rec);
+std::string normalizeSearchPrefix(const std::string& text);
+unsigned char toUpperCP866(unsigned char c);
 Queue binarySearchWithIndexing(const std::vector<Record*>& indices, const std::string& prefix);
 
 #endif
\ No newline at end of file
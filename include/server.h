@@ -0,0 +1,36 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "database.h"
+#include "batch.h"
+#include "indexes.h"
+#include "columns.h"
+#include "textsearch.h"
+#include <string>
+#include <vector>
+
+#define SERVER_MAX_INPUT (1 << 20)
+#define SERVER_MAX_OUTPUT (64 << 20)
+#define SERVER_OUTPUT_PAUSE (256 << 10)
+
+struct ServerOptions {
+    std::string socketPath;
+    int threads;
+    BatchFormat format;
+    std::vector<std::string> dbFiles;
+};
+
+struct ServerSnapshot {
+    const std::vector<Record>* db;
+    const std::vector<Record*>* indices;
+    SecondaryIndexes* indexes;
+    ColumnStore* columns;
+    TextSearchIndex* textSearch;
+    BatchShared* shared;
+};
+
+int runServer(const ServerOptions& opts, const ServerSnapshot& snapshot);
+bool readSocketLine(int fd, std::string& buffer, std::string& line);
+bool writeSocketAll(int fd, const char* data, size_t len);
+
+#endif
@@ -2,7 +2,31 @@
 #define SHANNON_H
 
 #include <string>
+#include <vector>
+#include <cstddef>
 
-void shannonCoding(const std::string& filename = "testBase1.dat");
+#define MAX_SYMBOLS 256
+#define MAX_CODE_LEN 256
 
-#endif
\ No newline at end of file
+typedef struct {
+    unsigned char symbol;
+    int freq;
+    char code[MAX_CODE_LEN];
+    int code_len;
+} SymbolInfo;
+
+struct ShannonCode {
+    SymbolInfo symbols[MAX_SYMBOLS];
+    double P[MAX_SYMBOLS];
+    int symbol_count;
+    size_t file_size;
+    double avg_length;
+    double entropy;
+};
+
+bool readWholeFile(const std::string& filename, std::vector<char>& buffer);
+bool buildShannonCode(const char* buffer, size_t size, ShannonCode& result);
+bool readWholeFiles(const std::vector<std::string>& filenames, std::vector<char>& buffer, std::string& failed);
+void shannonCoding(const std::vector<std::string>& filenames);
+
+#endif
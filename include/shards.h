@@ -0,0 +1,19 @@
+#ifndef SHARDS_H
+#define SHARDS_H
+
+#include "database.h"
+#include "sort.h"
+#include <vector>
+#include <string>
+
+struct DatabaseShard {
+    std::string filename;
+    size_t first;
+    size_t count;
+};
+
+bool loadShardedDatabase(const std::vector<std::string>& files, std::vector<Record>& db,
+                         std::vector<DatabaseShard>& shards);
+void sortShardedIndex(std::vector<Record*>& indices, const std::vector<DatabaseShard>& shards, SortMethod method);
+
+#endif
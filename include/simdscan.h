@@ -0,0 +1,29 @@
+#ifndef SIMDSCAN_H
+#define SIMDSCAN_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#define SCAN_PADDING 32
+
+enum ScanIsa {
+    SCAN_SCALAR,
+    SCAN_SSE2,
+    SCAN_AVX2
+};
+
+ScanIsa detectScanIsa();
+ScanIsa activeScanIsa();
+void setScanIsa(ScanIsa isa);
+const char* scanIsaName(ScanIsa isa);
+
+void filterRangeBitmap(const int16_t* column, size_t rows, int low, int high, std::vector<uint64_t>& bitmap);
+void filterTextBitmap(const char* column, size_t width, size_t rows, const char* key, size_t keyLen,
+                      bool prefix, std::vector<uint64_t>& bitmap);
+void filterSubstringBitmap(const char* column, size_t width, size_t rows, const char* needle, size_t len,
+                           std::vector<uint64_t>& bitmap);
+void bitmapToRows(const std::vector<uint64_t>& bitmap, size_t rows, std::vector<uint32_t>& out);
+size_t bitmapCount(const std::vector<uint64_t>& bitmap);
+
+#endif
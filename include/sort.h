@@ -2,7 +2,241 @@
 #define SORT_H
 
 #include "database.h"
+#include "transcode.h"
+#include "instrument.h"
+#include <algorithm>
 
 void quickSortHoare(std::vector<Record*>& indices, int left, int right);
 
-#endif
\ No newline at end of file
+struct SurnameKey {
+    static int compare(const Record& a, const Record& b) {
+        size_t alen, blen;
+        const char* pa = surnameBytes(a, alen);
+        const char* pb = surnameBytes(b, blen);
+        return compareCP866(pa, alen, pb, blen);
+    }
+};
+
+typedef SurnameKey SurnameIndexKey;
+
+template <RecordField Field>
+struct TextFieldKey {
+    static int compare(const Record& a, const Record& b) {
+        size_t alen, blen;
+        const char* pa = recordFieldBytes(a, Field, alen);
+        const char* pb = recordFieldBytes(b, Field, blen);
+        return compareCP866(pa, alen, pb, blen);
+    }
+};
+
+typedef TextFieldKey<FIELD_AUTHOR> AuthorKey;
+typedef TextFieldKey<FIELD_TITLE> TitleKey;
+typedef TextFieldKey<FIELD_PUBLISHER> PublisherKey;
+
+struct YearKey {
+    static int compare(const Record& a, const Record& b) {
+        return a.year - b.year;
+    }
+};
+
+struct PagesKey {
+    static int compare(const Record& a, const Record& b) {
+        return a.pages - b.pages;
+    }
+};
+
+template <typename... Keys>
+struct SortKey {
+    static int compare(const Record& a, const Record& b) {
+        int result = 0;
+        (void)((result = Keys::compare(a, b), result != 0) || ...);
+        return result;
+    }
+};
+
+template <typename Key>
+int partitionBy(std::vector<Record*>& indices, int left, int right) {
+    INSTR_TIMER("sort.partition");
+    const Record& pivot = *indices[left + (right - left) / 2];
+
+    int i = left - 1;
+    int j = right + 1;
+
+    while (true) {
+        do {
+            i++;
+            INSTR_COUNT("sort.compare");
+        } while (Key::compare(*indices[i], pivot) < 0);
+
+        do {
+            j--;
+            INSTR_COUNT("sort.compare");
+        } while (Key::compare(*indices[j], pivot) > 0);
+
+        if (i >= j) {
+            return j;
+        }
+
+        INSTR_COUNT("sort.swap");
+        std::swap(indices[i], indices[j]);
+    }
+}
+
+template <typename Key>
+void quickSortBy(std::vector<Record*>& indices, int left, int right) {
+    while (left < right) {
+        int split_pos = partitionBy<Key>(indices, left, right);
+
+        if (split_pos - left < right - split_pos) {
+            quickSortBy<Key>(indices, left, split_pos);
+            left = split_pos + 1;
+        } else {
+            quickSortBy<Key>(indices, split_pos + 1, right);
+            right = split_pos;
+        }
+    }
+}
+
+template <typename... Keys>
+void sortRecordsBy(std::vector<Record*>& indices) {
+    if (indices.size() > 1) quickSortBy<SortKey<Keys...>>(indices, 0, indices.size() - 1);
+}
+
+#define ADAPTIVE_MIN_MERGE 32
+
+inline int adaptiveMinRun(int n) {
+    int low = 0;
+    while (n >= ADAPTIVE_MIN_MERGE) {
+        low |= n & 1;
+        n >>= 1;
+    }
+    return n + low;
+}
+
+template <typename Key>
+int countRunBy(std::vector<Record*>& indices, int left, int right) {
+    int run = left + 1;
+    if (run >= right) return right;
+
+    INSTR_COUNT("sort.compare");
+    if (Key::compare(*indices[run], *indices[left]) < 0) {
+        while (run + 1 < right && Key::compare(*indices[run + 1], *indices[run]) < 0) {
+            INSTR_COUNT("sort.compare");
+            run++;
+        }
+        std::reverse(indices.begin() + left, indices.begin() + run + 1);
+    } else {
+        while (run + 1 < right && Key::compare(*indices[run + 1], *indices[run]) >= 0) {
+            INSTR_COUNT("sort.compare");
+            run++;
+        }
+    }
+    return run + 1;
+}
+
+template <typename Key>
+void binaryInsertionSortBy(std::vector<Record*>& indices, int left, int sorted, int right) {
+    for (int i = sorted; i < right; ++i) {
+        Record* rec = indices[i];
+        auto pos = std::upper_bound(indices.begin() + left, indices.begin() + i, rec,
+            [](const Record* a, const Record* b) { return Key::compare(*a, *b) < 0; });
+        std::move_backward(pos, indices.begin() + i, indices.begin() + i + 1);
+        *pos = rec;
+    }
+}
+
+template <typename Key>
+void mergeRunsBy(std::vector<Record*>& indices, std::vector<Record*>& buffer, int left, int mid, int right) {
+    INSTR_TIMER("sort.merge");
+    auto less = [](const Record* a, const Record* b) { return Key::compare(*a, *b) < 0; };
+    auto begin = indices.begin();
+    left = std::upper_bound(begin + left, begin + mid, indices[mid], less) - begin;
+    right = std::lower_bound(begin + mid, begin + right, indices[mid - 1], less) - begin;
+    if (left >= mid || mid >= right) return;
+
+    buffer.assign(begin + left, begin + mid);
+    auto a = buffer.begin();
+    auto b = begin + mid;
+    auto out = begin + left;
+    while (a != buffer.end() && b != begin + right) {
+        INSTR_COUNT("sort.compare");
+        *out++ = less(*b, *a) ? *b++ : *a++;
+    }
+    std::copy(a, buffer.end(), out);
+}
+
+template <typename Key>
+void adaptiveSortBy(std::vector<Record*>& indices) {
+    int n = indices.size();
+    if (n < 2) return;
+
+    int minRun = adaptiveMinRun(n);
+    std::vector<Record*> buffer;
+    std::vector<std::pair<int, int>> runs;
+
+    for (int start = 0; start < n;) {
+        int end = countRunBy<Key>(indices, start, n);
+        if (end - start < minRun) {
+            int forced = std::min(n, start + minRun);
+            binaryInsertionSortBy<Key>(indices, start, end, forced);
+            end = forced;
+        }
+        runs.emplace_back(start, end - start);
+        start = end;
+
+        while (runs.size() > 1) {
+            int k = runs.size() - 2;
+            if ((k > 0 && runs[k - 1].second <= runs[k].second + runs[k + 1].second) ||
+                (k > 1 && runs[k - 2].second <= runs[k - 1].second + runs[k].second)) {
+                if (runs[k - 1].second < runs[k + 1].second) k--;
+            } else if (runs[k].second > runs[k + 1].second) {
+                break;
+            }
+            mergeRunsBy<Key>(indices, buffer, runs[k].first, runs[k + 1].first,
+                             runs[k + 1].first + runs[k + 1].second);
+            runs[k].second += runs[k + 1].second;
+            runs.erase(runs.begin() + k + 1);
+        }
+    }
+
+    while (runs.size() > 1) {
+        int k = runs.size() - 2;
+        if (k > 0 && runs[k - 1].second < runs[k + 1].second) k--;
+        mergeRunsBy<Key>(indices, buffer, runs[k].first, runs[k + 1].first,
+                         runs[k + 1].first + runs[k + 1].second);
+        runs[k].second += runs[k + 1].second;
+        runs.erase(runs.begin() + k + 1);
+    }
+}
+
+enum SortMethod {
+    SORT_METHOD_HOARE,
+    SORT_METHOD_ADAPTIVE
+};
+
+bool parseSortMethod(const std::string& name, SortMethod& method);
+void sortSurnameIndex(std::vector<Record*>& indices, SortMethod method);
+
+enum SortOrder {
+    SORT_SURNAME,
+    SORT_SURNAME_YEAR,
+    SORT_AUTHOR_TITLE,
+    SORT_PUBLISHER_PAGES,
+    SORT_YEAR_PAGES
+};
+
+#define INCREMENTAL_SORT_CUTOFF 64
+
+struct IncrementalSort {
+    std::vector<Record*> indices;
+    std::vector<std::pair<int, int>> pending;
+};
+
+void initIncrementalSort(IncrementalSort& sort, const std::vector<Record*>& indices);
+void ensureSortedRange(IncrementalSort& sort, int begin, int end);
+bool incrementalSortDone(const IncrementalSort& sort);
+
+bool parseSortOrder(const std::string& name, SortOrder& order);
+void sortRecords(std::vector<Record*>& indices, SortOrder order);
+
+#endif
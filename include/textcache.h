@@ -0,0 +1,26 @@
+#ifndef TEXTCACHE_H
+#define TEXTCACHE_H
+
+#include "database.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define RECORD_TEXT_WARM_CHUNK 4096
+
+struct CachedRecordText {
+    std::string author;
+    std::string title;
+    std::string publisher;
+};
+
+typedef std::shared_ptr<const CachedRecordText> RecordTextRef;
+
+void attachRecordTextCache(const std::vector<Record>& db);
+RecordTextRef cachedRecordText(const Record* rec);
+void warmRecordTextCache(const std::vector<Record>& db, const std::atomic<bool>& stop);
+void clearRecordTextCache();
+size_t recordTextCacheSize();
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef TEXTSEARCH_H
+#define TEXTSEARCH_H
+
+#include "database.h"
+#include "queue.h"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct TextSearchIndex {
+    const std::vector<Record>* db;
+    const std::vector<Record*>* sorted;
+    std::mutex mutex;
+    size_t rows;
+    std::vector<char> author;
+    std::vector<char> title;
+    std::vector<uint32_t> rank;
+    std::vector<std::string> words;
+    std::vector<std::vector<uint32_t>> wordRows;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> trigramWords;
+};
+
+void initTextSearchIndex(TextSearchIndex& index, const std::vector<Record>& db, const std::vector<Record*>& sorted);
+void buildTextSearchIndex(TextSearchIndex& index);
+std::string foldSearchText(const std::string& utf8);
+int editDistance(const std::string& a, const std::string& b, int limit);
+Queue substringSearch(TextSearchIndex& index, const std::string& text);
+Queue fuzzySearch(TextSearchIndex& index, const std::string& word, int maxDistance);
+int defaultFuzzyDistance(const std::string& word);
+
+#endif
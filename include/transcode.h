@@ -0,0 +1,18 @@
+#ifndef TRANSCODE_H
+#define TRANSCODE_H
+
+#include "database.h"
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#define CP866_UTF8_MAX_BYTES 3
+
+const char* cp866CharUTF8(unsigned char c, size_t& len);
+size_t transcodeCP866ToUTF8(const char* src, size_t len, char* dst);
+std::string cp866ToUTF8(const char* src, size_t len);
+void transcodeColumn(const std::vector<Record>& db, RecordField field, std::vector<std::string>& out);
+std::string utf8ToCP866(const std::string& utf8);
+int compareCP866(const char* a, size_t alen, const char* b, size_t blen);
+
+#endif
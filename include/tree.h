@@ -3,28 +3,41 @@
 
 #include "database.h"
 #include "queue.h"
+#include <cstdint>
 #include <vector>
 #include <string>
-#include <map>
+#include <memory_resource>
 
 struct TreeNode {
-    std::string key;
-    std::vector<Record*> records;
+    int key;
+    Record** records;
+    int recordCount;
     int weight;
     TreeNode* left;
     TreeNode* right;
 };
 
+struct TreeLookup {
+    Record* const* records;
+    int count;
+};
+
 struct OptimalSearchTree {
     TreeNode* root;
     int totalKeys;
     int totalRecords;
     std::string keyType;
+    std::pmr::monotonic_buffer_resource arena;
+
+    explicit OptimalSearchTree(size_t arenaSize) : root(nullptr), totalKeys(0), totalRecords(0), arena(arenaSize) {}
 };
 
 OptimalSearchTree* buildOptimalSearchTreeA1(Queue& queue);
 void printOptimalTree(const OptimalSearchTree* tree);
 std::vector<Record*> searchInTreeByPages(OptimalSearchTree* tree, int pages);
+uint64_t pagesQueryKey(int pages);
+std::vector<uint64_t> sortPagesQueries(const std::vector<int>& pages);
+std::vector<TreeLookup> searchInTreeByPagesBatch(const OptimalSearchTree* tree, const std::vector<int>& pages);
 void displayTreeSearchResults(const std::vector<Record*>& results, int search_pages);
 void displayTreeTraversals(OptimalSearchTree* tree);
 void clearOptimalTree(OptimalSearchTree* tree);
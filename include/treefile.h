@@ -0,0 +1,58 @@
+#ifndef TREEFILE_H
+#define TREEFILE_H
+
+#include "database.h"
+#include "tree.h"
+#include <cstdint>
+#include <vector>
+#include <string>
+
+#define TREE_FILE_MAGIC "SAODA1T"
+#define TREE_FILE_VERSION 2
+
+struct TreeFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t nodeCount;
+    uint32_t recordCount;
+    uint32_t dbRecords;
+    uint64_t nodesOffset;
+    uint64_t recordsOffset;
+    uint64_t dbFingerprint;
+};
+
+struct TreeFileNode {
+    int32_t key;
+    int32_t weight;
+    uint32_t firstRecord;
+    uint32_t recordCount;
+    int32_t left;
+    int32_t right;
+};
+
+struct MappedTree {
+    void* base;
+    size_t size;
+    uint64_t device;
+    uint64_t inode;
+    int64_t modified;
+    const TreeFileHeader* header;
+    const TreeFileNode* nodes;
+    const uint32_t* records;
+};
+
+struct MappedTreeLookup {
+    const uint32_t* ordinals;
+    uint32_t count;
+};
+
+bool saveOptimalTree(const OptimalSearchTree* tree, const std::vector<Record>& db, const std::string& filename);
+uint64_t databaseFingerprint(const std::vector<Record>& db);
+bool openMappedTree(MappedTree& tree, const std::string& filename, const std::vector<Record>& db);
+bool mappedTreeCurrent(const MappedTree& tree, const std::string& filename);
+void closeMappedTree(MappedTree& tree);
+std::vector<Record*> searchMappedTreeByPages(const MappedTree& tree, const std::vector<Record>& db, int pages);
+std::vector<MappedTreeLookup> searchMappedTreeByPagesBatch(const MappedTree& tree, const std::vector<int>& pages);
+std::vector<Record*> mappedLookupRecords(const std::vector<Record>& db, const MappedTreeLookup& lookup);
+
+#endif
@@ -0,0 +1,254 @@
+#include "aggregate.h"
+#include "search.h"
+#include "instrument.h"
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+bool parseGroupKey(const std::string& name, GroupKey& key, int& prefixLetters) {
+    prefixLetters = AGGREGATE_MAX_PREFIX;
+    if (name == "author") key = GROUP_AUTHOR;
+    else if (name == "publisher") key = GROUP_PUBLISHER;
+    else if (name == "year") key = GROUP_YEAR;
+    else if (name.compare(0, 7, "surname") == 0) {
+        key = GROUP_SURNAME;
+        if (name.size() == 7) return true;
+        if (name.size() != 9 || name[7] != ':' || name[8] < '1' || name[8] > '0' + AGGREGATE_MAX_PREFIX) return false;
+        prefixLetters = name[8] - '0';
+    } else {
+        return false;
+    }
+    return true;
+}
+
+double averagePages(const ColumnSummary& summary) {
+    return summary.count > 0 ? double(summary.sum) / summary.count : 0.0;
+}
+
+static void addPages(ColumnSummary& summary, int pages) {
+    if (summary.count == 0) {
+        summary.min = summary.max = pages;
+    } else {
+        summary.min = std::min(summary.min, pages);
+        summary.max = std::max(summary.max, pages);
+    }
+    summary.count++;
+    summary.sum += pages;
+}
+
+static void mergeSummary(ColumnSummary& into, const ColumnSummary& from) {
+    if (from.count == 0) return;
+    if (into.count == 0) {
+        into = from;
+        return;
+    }
+    into.count += from.count;
+    into.sum += from.sum;
+    into.min = std::min(into.min, from.min);
+    into.max = std::max(into.max, from.max);
+}
+
+static int aggregateThreads(size_t rows, int threads) {
+    if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t useful = std::max<size_t>(1, rows / AGGREGATE_MIN_ROWS_PER_THREAD);
+    return static_cast<int>(std::min<size_t>(threads, useful));
+}
+
+template <typename Partial, typename Body>
+static std::vector<Partial> runPartials(size_t rows, int threads, Body body) {
+    int count = aggregateThreads(rows, threads);
+    std::vector<Partial> partials(count);
+    std::vector<std::thread> workers;
+    for (int t = 1; t < count; ++t) {
+        workers.emplace_back([&partials, &body, rows, count, t] {
+            body(partials[t], rows * t / count, rows * (t + 1) / count);
+        });
+    }
+    body(partials[0], 0, rows / count);
+    for (std::thread& worker : workers) worker.join();
+    return partials;
+}
+
+template <typename GroupOf>
+static std::vector<ColumnSummary> aggregateDense(size_t rows, size_t groups, const int16_t* pages, int threads,
+                                          GroupOf groupOf) {
+    std::vector<std::vector<ColumnSummary>> partials = runPartials<std::vector<ColumnSummary>>(rows, threads,
+        [groups, pages, &groupOf](std::vector<ColumnSummary>& local, size_t begin, size_t end) {
+            local.assign(groups, ColumnSummary{0, 0, 0, 0});
+            for (size_t row = begin; row < end; ++row) addPages(local[groupOf(row)], pages[row]);
+        });
+    for (size_t t = 1; t < partials.size(); ++t) {
+        for (size_t g = 0; g < groups; ++g) mergeSummary(partials[0][g], partials[t][g]);
+    }
+    return std::move(partials[0]);
+}
+
+namespace {
+
+struct TextGroupKey {
+    uint64_t words[2];
+
+    bool operator==(const TextGroupKey& other) const {
+        return words[0] == other.words[0] && words[1] == other.words[1];
+    }
+    bool operator<(const TextGroupKey& other) const {
+        return memcmp(this, &other, sizeof(TextGroupKey)) < 0;
+    }
+};
+
+template <typename Key>
+struct GroupSlot {
+    Key key;
+    ColumnSummary pages;
+};
+
+template <typename Key>
+struct GroupTable {
+    std::vector<GroupSlot<Key>> slots;
+    size_t used = 0;
+};
+
+}
+
+static size_t mixGroupHash(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    return static_cast<size_t>(h);
+}
+
+static size_t groupHash(uint32_t key) {
+    return mixGroupHash(key);
+}
+
+static size_t groupHash(const TextGroupKey& key) {
+    return mixGroupHash(key.words[0] ^ (key.words[1] * 0x9E3779B97F4A7C15ull));
+}
+
+template <typename Key>
+static size_t findGroupSlot(const GroupTable<Key>& table, const Key& key) {
+    size_t mask = table.slots.size() - 1;
+    size_t i = groupHash(key) & mask;
+    while (table.slots[i].pages.count != 0 && !(table.slots[i].key == key)) i = (i + 1) & mask;
+    return i;
+}
+
+template <typename Key>
+static ColumnSummary& groupSlot(GroupTable<Key>& table, const Key& key) {
+    if ((table.used + 1) * 2 > table.slots.size()) {
+        GroupTable<Key> grown;
+        grown.slots.assign(std::max<size_t>(64, table.slots.size() * 2), GroupSlot<Key>{Key{}, ColumnSummary{0, 0, 0, 0}});
+        for (const GroupSlot<Key>& slot : table.slots) {
+            if (slot.pages.count != 0) grown.slots[findGroupSlot(grown, slot.key)] = slot;
+        }
+        grown.used = table.used;
+        table = std::move(grown);
+    }
+    GroupSlot<Key>& slot = table.slots[findGroupSlot(table, key)];
+    if (slot.pages.count == 0) {
+        slot.key = key;
+        table.used++;
+    }
+    return slot.pages;
+}
+
+template <typename Key, typename KeyOf>
+static std::vector<std::pair<Key, ColumnSummary>> aggregateSparse(size_t rows, const int16_t* pages, int threads,
+                                                           KeyOf keyOf) {
+    std::vector<GroupTable<Key>> partials = runPartials<GroupTable<Key>>(rows, threads,
+        [pages, &keyOf](GroupTable<Key>& local, size_t begin, size_t end) {
+            for (size_t row = begin; row < end; ++row) addPages(groupSlot(local, keyOf(row)), pages[row]);
+        });
+    for (size_t t = 1; t < partials.size(); ++t) {
+        for (const GroupSlot<Key>& slot : partials[t].slots) {
+            if (slot.pages.count != 0) mergeSummary(groupSlot(partials[0], slot.key), slot.pages);
+        }
+    }
+    std::vector<std::pair<Key, ColumnSummary>> entries;
+    entries.reserve(partials[0].used);
+    for (const GroupSlot<Key>& slot : partials[0].slots) {
+        if (slot.pages.count != 0) entries.emplace_back(slot.key, slot.pages);
+    }
+    std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    return entries;
+}
+
+static std::vector<std::pair<size_t, ColumnSummary>> denseEntries(const std::vector<ColumnSummary>& summaries) {
+    std::vector<std::pair<size_t, ColumnSummary>> entries;
+    for (size_t i = 0; i < summaries.size(); ++i) {
+        if (summaries[i].count > 0) entries.emplace_back(i, summaries[i]);
+    }
+    return entries;
+}
+
+template <typename Key, typename ValueOf>
+static void appendGroups(std::vector<std::pair<Key, ColumnSummary>>& entries, bool byCount, size_t limit, ValueOf valueOf,
+                  std::vector<GroupAggregate>& groups) {
+    if (byCount) {
+        std::stable_sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+            return a.second.count > b.second.count;
+        });
+    }
+    if (limit > 0 && limit < entries.size()) entries.resize(limit);
+    groups.reserve(entries.size());
+    for (const auto& entry : entries) groups.push_back({valueOf(entry.first), entry.second});
+}
+
+std::vector<GroupAggregate> aggregateGroups(const ColumnStore& store, GroupKey key, int prefixLetters, size_t limit,
+                                            int threads) {
+    INSTR_TIMER("aggregate.groups");
+    std::vector<GroupAggregate> groups;
+    const int16_t* pages = numericColumn(store, FIELD_PAGES);
+    if (store.rows == 0) return groups;
+
+    if (key == GROUP_YEAR) {
+        const int16_t* year = numericColumn(store, FIELD_YEAR);
+        ColumnSummary years = summarizeColumn(store, FIELD_YEAR);
+        int low = years.min;
+        auto entries = denseEntries(aggregateDense(store.rows, years.max - low + 1, pages, threads,
+            [year, low](size_t row) { return year[row] - low; }));
+        appendGroups(entries, false, limit, [low](size_t i) { return std::to_string(low + int(i)); }, groups);
+    } else if (key == GROUP_SURNAME) {
+        int letters = std::min(std::max(prefixLetters, 1), AGGREGATE_MAX_PREFIX);
+        const Record* db = store.db->data();
+        auto entries = aggregateSparse<uint32_t>(store.rows, pages, threads, [db, letters](size_t row) {
+            size_t len;
+            const char* surname = surnameBytes(db[row], len);
+            uint32_t packed = 0;
+            for (int i = 0; i < letters; ++i) {
+                packed = (packed << 8) | (size_t(i) < len ? toUpperCP866(surname[i]) : 0);
+            }
+            return packed;
+        });
+        appendGroups(entries, true, limit, [letters](uint32_t packed) {
+            char bytes[AGGREGATE_MAX_PREFIX];
+            size_t len = 0;
+            for (int i = letters - 1; i >= 0; --i) {
+                char c = static_cast<char>(packed >> (8 * i));
+                if (c != 0) bytes[len++] = c;
+            }
+            return recordFieldText(bytes, len);
+        }, groups);
+    } else {
+        RecordField field = key == GROUP_AUTHOR ? FIELD_AUTHOR : FIELD_PUBLISHER;
+        const DictionaryColumn* dict = dictionaryColumn(store, field);
+        if (dict != nullptr) {
+            const int16_t* codes = dict->codes.data();
+            auto entries = denseEntries(aggregateDense(store.rows, dict->size, pages, threads,
+                [codes](size_t row) { return codes[row]; }));
+            appendGroups(entries, true, limit, [dict](size_t code) { return dictionaryValue(*dict, code); }, groups);
+        } else {
+            size_t width;
+            const char* text = textColumn(store, field, width);
+            auto entries = aggregateSparse<TextGroupKey>(store.rows, pages, threads, [text, width](size_t row) {
+                TextGroupKey key{{0, 0}};
+                memcpy(key.words, text + row * width, std::min(width, sizeof(key.words)));
+                return key;
+            });
+            appendGroups(entries, true, limit, [width](const TextGroupKey& key) {
+                return recordFieldText(reinterpret_cast<const char*>(key.words), std::min(width, sizeof(key.words)));
+            }, groups);
+        }
+    }
+    return groups;
+}
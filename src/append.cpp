@@ -0,0 +1,129 @@
+#include "append.h"
+#include "sort.h"
+#include "search.h"
+#include "instrument.h"
+#include <algorithm>
+
+bool appendRecordsToFile(const std::string& filename, const std::vector<Record>& batch) {
+    std::ofstream file(filename, std::ios::binary | std::ios::app);
+    if (!file) return false;
+    file.write(reinterpret_cast<const char*>(batch.data()), batch.size() * sizeof(Record));
+    return static_cast<bool>(file);
+}
+
+template <typename Less>
+void mergeBatch(std::vector<Record*>& sorted, const std::vector<Record*>& batch, Less less) {
+    if (batch.empty()) return;
+
+    std::vector<Record*> merged;
+    merged.reserve(sorted.size() + batch.size());
+    auto from = sorted.begin();
+    for (Record* rec : batch) {
+        auto pos = std::upper_bound(from, sorted.end(), rec, less);
+        merged.insert(merged.end(), from, pos);
+        merged.push_back(rec);
+        from = pos;
+    }
+    merged.insert(merged.end(), from, sorted.end());
+    sorted.swap(merged);
+}
+
+void mergeSortedBatch(std::vector<Record*>& sorted, const std::vector<Record*>& batch) {
+    INSTR_TIMER("append.merge");
+    mergeBatch(sorted, batch, [](const Record* a, const Record* b) {
+        return SurnameIndexKey::compare(*a, *b) < 0;
+    });
+}
+
+std::vector<size_t> recordOffsets(const std::vector<Record*>& records, const Record* base) {
+    std::vector<size_t> offsets;
+    offsets.reserve(records.size());
+    for (const Record* rec : records) offsets.push_back(rec - base);
+    return offsets;
+}
+
+void rebaseRecords(std::vector<Record*>& records, const std::vector<size_t>& offsets, Record* base) {
+    for (size_t i = 0; i < records.size(); ++i) records[i] = base + offsets[i];
+}
+
+void dropAffectedPrefixes(PrefixCache& cache, const std::vector<Record*>& batch) {
+    std::vector<std::string> prefixes;
+    for (const Record* rec : batch) prefixes.push_back(normalizeSearchPrefix(extractSurname(*rec)));
+
+    for (auto it = cache.entries.begin(); it != cache.entries.end();) {
+        bool affected = false;
+        for (const std::string& prefix : prefixes) {
+            if (prefix.compare(0, it->prefix.size(), it->prefix) == 0) {
+                affected = true;
+                break;
+            }
+        }
+        if (affected) {
+            cache.lookup.erase(it->prefix);
+            clearQueue(it->queue);
+            if (it->tree != nullptr) clearOptimalTree(it->tree);
+            it = cache.entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+bool appendRecords(const std::string& filename,
+                   std::vector<Record>& db,
+                   std::vector<Record*>& sorted,
+                   SecondaryIndexes& indexes,
+                   PrefixCache* prefixCache,
+                   const std::vector<Record>& batch) {
+    INSTR_TIMER("append.records");
+    if (batch.empty()) return true;
+    if (!appendRecordsToFile(filename, batch)) return false;
+
+    size_t oldSize = db.size();
+    bool moved = db.capacity() < oldSize + batch.size();
+    std::vector<size_t> sortedOffsets;
+    std::vector<size_t> indexOffsets[SECONDARY_INDEX_COUNT];
+    if (moved) {
+        sortedOffsets = recordOffsets(sorted, db.data());
+        for (int field = 0; field < SECONDARY_INDEX_COUNT; ++field) {
+            if (indexes.ready[field]) indexOffsets[field] = recordOffsets(indexes.byField[field], db.data());
+        }
+    }
+
+    db.insert(db.end(), batch.begin(), batch.end());
+
+    if (moved) {
+        rebaseRecords(sorted, sortedOffsets, db.data());
+        for (int field = 0; field < SECONDARY_INDEX_COUNT; ++field) {
+            if (indexes.ready[field]) rebaseRecords(indexes.byField[field], indexOffsets[field], db.data());
+        }
+        if (prefixCache != nullptr) invalidatePrefixCache(*prefixCache);
+    }
+
+    std::vector<Record*> added;
+    added.reserve(batch.size());
+    for (size_t i = oldSize; i < db.size(); ++i) added.push_back(&db[i]);
+
+    if (prefixCache != nullptr && !moved) {
+        dropAffectedPrefixes(*prefixCache, added);
+        if (prefixCache->source == &sorted) prefixCache->sourceSize = sorted.size() + added.size();
+    }
+
+    for (int field = 0; field < SECONDARY_INDEX_COUNT; ++field) {
+        if (!indexes.ready[field]) continue;
+        RecordField recordField = static_cast<RecordField>(field);
+        std::vector<Record*> byField = added;
+        std::stable_sort(byField.begin(), byField.end(), [recordField](const Record* a, const Record* b) {
+            return compareRecordsByField(*a, *b, recordField) < 0;
+        });
+        mergeBatch(indexes.byField[field], byField, [recordField](const Record* a, const Record* b) {
+            return compareRecordsByField(*a, *b, recordField) < 0;
+        });
+    }
+
+    std::stable_sort(added.begin(), added.end(), [](const Record* a, const Record* b) {
+        return SurnameIndexKey::compare(*a, *b) < 0;
+    });
+    mergeSortedBatch(sorted, added);
+    return true;
+}
@@ -0,0 +1,685 @@
+#include "batch.h"
+#include "instrument.h"
+#include "search.h"
+#include "textcache.h"
+#include <cerrno>
+#include <cstdlib>
+#include <functional>
+#include <sstream>
+
+void initBatchShared(BatchShared& shared, size_t prefixShards) {
+    shared.prefixShards = std::vector<PrefixCacheShard>(std::max<size_t>(prefixShards, 1));
+    size_t capacity = std::max<size_t>(PREFIX_CACHE_CAPACITY / shared.prefixShards.size(), 1);
+    for (PrefixCacheShard& shard : shared.prefixShards) initPrefixCache(shard.cache, capacity);
+    shared.orderings.clear();
+    shared.shannon = nullptr;
+}
+
+void clearBatchShared(BatchShared& shared) {
+    for (PrefixCacheShard& shard : shared.prefixShards) clearPrefixCache(shard.cache);
+    shared.orderings.clear();
+    delete shared.shannon;
+    shared.shannon = nullptr;
+}
+
+void writeBatchSharedStats(BatchShared& shared, std::ostream& out) {
+    if (shared.prefixShards.size() == 1) {
+        writePrefixCacheStats(shared.prefixShards[0].cache, out);
+        return;
+    }
+    PrefixCache total;
+    initPrefixCache(total, 0);
+    total.capacity = 0;
+    size_t entries = 0;
+    for (PrefixCacheShard& shard : shared.prefixShards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        entries += shard.cache.entries.size();
+        total.capacity += shard.cache.capacity;
+        total.hits += shard.cache.hits;
+        total.misses += shard.cache.misses;
+        total.evictions += shard.cache.evictions;
+        total.treeHits += shard.cache.treeHits;
+        total.treeBuilds += shard.cache.treeBuilds;
+    }
+    long long lookups = total.hits + total.misses;
+    out << "Кэш префиксов (" << shared.prefixShards.size() << " частей): " << entries << "/" << total.capacity
+        << ", попаданий " << total.hits << " из " << lookups
+        << ", вытеснений " << total.evictions
+        << ", деревьев построено " << total.treeBuilds
+        << ", взято из кэша " << total.treeHits << std::endl;
+}
+
+void initBatchContext(BatchContext& ctx, const std::vector<Record>& db, const std::vector<Record*>& indices,
+                      SecondaryIndexes& indexes, ColumnStore& columns, TextSearchIndex& textSearch,
+                      BatchShared& shared, const std::vector<std::string>& dbFiles, BatchFormat format) {
+    ctx.db = &db;
+    ctx.indices = &indices;
+    ctx.indexes = &indexes;
+    ctx.columns = &columns;
+    ctx.textSearch = &textSearch;
+    ctx.dbFiles = dbFiles;
+    ctx.format = format;
+    ctx.threads = 0;
+    ctx.fileCommands = true;
+    ctx.shared = &shared;
+    ctx.mappedTrees.clear();
+}
+
+void clearBatchContext(BatchContext& ctx) {
+    for (auto& mapped : ctx.mappedTrees) closeMappedTree(mapped.second);
+    ctx.mappedTrees.clear();
+}
+
+void dropMappedTree(BatchContext& ctx, const std::string& filename) {
+    auto it = ctx.mappedTrees.find(filename);
+    if (it == ctx.mappedTrees.end()) return;
+    closeMappedTree(it->second);
+    ctx.mappedTrees.erase(it);
+}
+
+bool parseBatchFormat(const std::string& name, BatchFormat& format) {
+    if (name == "tsv") format = BATCH_TSV;
+    else if (name == "json") format = BATCH_JSON;
+    else return false;
+    return true;
+}
+
+void appendJsonString(std::string& out, const std::string& text) {
+    out += '"';
+    for (char c : text) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            case '\r': out += "\\r"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(c));
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+void appendTsvField(std::string& out, const std::string& text) {
+    for (char c : text) {
+        out += (c == '\t' || c == '\n' || c == '\r') ? ' ' : c;
+    }
+}
+
+void appendQueryHeader(const BatchContext& ctx, std::string& out, long long id, const std::string& query) {
+    if (ctx.format == BATCH_JSON) {
+        out += "{\"id\":" + std::to_string(id) + ",\"query\":";
+        appendJsonString(out, query);
+    }
+}
+
+void emitError(const BatchContext& ctx, std::string& out, long long id, const std::string& query, const std::string& message) {
+    if (ctx.format == BATCH_JSON) {
+        appendQueryHeader(ctx, out, id, query);
+        out += ",\"error\":";
+        appendJsonString(out, message);
+        out += "}\n";
+    } else {
+        out += std::to_string(id) + "\terror\t";
+        appendTsvField(out, message);
+        out += '\n';
+    }
+}
+
+void appendRecordsJson(std::string& out, const std::vector<Record*>& records) {
+    out += ",\"count\":" + std::to_string(records.size()) + ",\"records\":[";
+    for (size_t i = 0; i < records.size(); ++i) {
+        const Record* rec = records[i];
+        RecordTextRef text = cachedRecordText(rec);
+        if (i > 0) out += ',';
+        out += "{\"author\":";
+        appendJsonString(out, text->author);
+        out += ",\"title\":";
+        appendJsonString(out, text->title);
+        out += ",\"publisher\":";
+        appendJsonString(out, text->publisher);
+        out += ",\"year\":" + std::to_string(rec->year);
+        out += ",\"pages\":" + std::to_string(rec->pages) + "}";
+    }
+    out += "]";
+}
+
+void appendRecordsTsv(std::string& out, const std::string& prefix, const std::vector<Record*>& records) {
+    for (const Record* rec : records) {
+        RecordTextRef text = cachedRecordText(rec);
+        out += prefix + "record\t";
+        appendTsvField(out, text->author);
+        out += '\t';
+        appendTsvField(out, text->title);
+        out += '\t';
+        appendTsvField(out, text->publisher);
+        out += '\t' + std::to_string(rec->year) + '\t' + std::to_string(rec->pages) + '\n';
+    }
+}
+
+void emitRecords(const BatchContext& ctx, std::string& out, long long id, const std::string& query,
+                 const std::vector<Record*>& records) {
+    if (ctx.format == BATCH_JSON) {
+        appendQueryHeader(ctx, out, id, query);
+        appendRecordsJson(out, records);
+        out += "}\n";
+    } else {
+        std::string prefix = std::to_string(id) + '\t';
+        out += prefix + "count\t" + std::to_string(records.size()) + '\n';
+        appendRecordsTsv(out, prefix, records);
+    }
+}
+
+void emitPagesGroups(const BatchContext& ctx, std::string& out, long long id, const std::string& query,
+                     const std::vector<int>& pages, const std::vector<std::vector<Record*>>& groups) {
+    if (ctx.format == BATCH_JSON) {
+        appendQueryHeader(ctx, out, id, query);
+        out += ",\"groups\":[";
+        for (size_t i = 0; i < groups.size(); ++i) {
+            if (i > 0) out += ',';
+            out += "{\"pages\":" + std::to_string(pages[i]);
+            appendRecordsJson(out, groups[i]);
+            out += "}";
+        }
+        out += "]}\n";
+    } else {
+        std::string prefix = std::to_string(id) + '\t';
+        for (size_t i = 0; i < groups.size(); ++i) {
+            out += prefix + "pages\t" + std::to_string(pages[i]) + '\t' + std::to_string(groups[i].size()) + '\n';
+            appendRecordsTsv(out, prefix, groups[i]);
+        }
+    }
+}
+
+void emitSummary(const BatchContext& ctx, std::string& out, long long id, const std::string& query,
+                 const ColumnSummary& summary) {
+    std::ostringstream avg;
+    avg << std::fixed << std::setprecision(2) << (summary.count > 0 ? double(summary.sum) / summary.count : 0.0);
+
+    if (ctx.format == BATCH_JSON) {
+        appendQueryHeader(ctx, out, id, query);
+        out += ",\"count\":" + std::to_string(summary.count);
+        out += ",\"sum\":" + std::to_string(summary.sum);
+        out += ",\"min\":" + std::to_string(summary.min);
+        out += ",\"max\":" + std::to_string(summary.max);
+        out += ",\"avg\":" + avg.str() + "}\n";
+    } else {
+        out += std::to_string(id) + "\tstat\t" + std::to_string(summary.count) + '\t' + std::to_string(summary.sum) +
+               '\t' + std::to_string(summary.min) + '\t' + std::to_string(summary.max) + '\t' + avg.str() + '\n';
+    }
+}
+
+void emitTreeFile(const BatchContext& ctx, std::string& out, long long id, const std::string& query,
+                  const OptimalSearchTree* tree) {
+    int keys = tree != nullptr ? tree->totalKeys : 0;
+    int records = tree != nullptr ? tree->totalRecords : 0;
+    if (ctx.format == BATCH_JSON) {
+        appendQueryHeader(ctx, out, id, query);
+        out += ",\"keys\":" + std::to_string(keys) + ",\"records\":" + std::to_string(records) + "}\n";
+    } else {
+        out += std::to_string(id) + "\tsaved\t" + std::to_string(keys) + '\t' + std::to_string(records) + '\n';
+    }
+}
+
+void emitGroups(const BatchContext& ctx, std::string& out, long long id, const std::string& query,
+                const std::vector<GroupAggregate>& groups) {
+    std::string prefix = std::to_string(id) + '\t';
+    if (ctx.format == BATCH_JSON) {
+        appendQueryHeader(ctx, out, id, query);
+        out += ",\"count\":" + std::to_string(groups.size()) + ",\"groups\":[";
+    } else {
+        out += prefix + "count\t" + std::to_string(groups.size()) + '\n';
+    }
+    for (size_t i = 0; i < groups.size(); ++i) {
+        const ColumnSummary& pages = groups[i].pages;
+        std::ostringstream avg;
+        avg << std::fixed << std::setprecision(2) << averagePages(pages);
+        if (ctx.format == BATCH_JSON) {
+            if (i > 0) out += ',';
+            out += "{\"value\":";
+            appendJsonString(out, groups[i].value);
+            out += ",\"count\":" + std::to_string(pages.count);
+            out += ",\"min\":" + std::to_string(pages.min);
+            out += ",\"max\":" + std::to_string(pages.max);
+            out += ",\"avg\":" + avg.str() + "}";
+        } else {
+            out += prefix + "group\t";
+            appendTsvField(out, groups[i].value);
+            out += '\t' + std::to_string(pages.count) + '\t' + std::to_string(pages.min) + '\t' +
+                   std::to_string(pages.max) + '\t' + avg.str() + '\n';
+        }
+    }
+    if (ctx.format == BATCH_JSON) out += "]}\n";
+}
+
+bool parseNumericField(const std::string& name, RecordField& field) {
+    return parseRecordField(name, field) && (field == FIELD_YEAR || field == FIELD_PAGES);
+}
+
+void emitShannon(const BatchContext& ctx, std::string& out, long long id, const std::string& query) {
+    const ShannonCode& code = *ctx.shared->shannon;
+    std::ostringstream avg, entropy;
+    avg << std::fixed << std::setprecision(6) << code.avg_length;
+    entropy << std::fixed << std::setprecision(6) << code.entropy;
+
+    if (ctx.format == BATCH_JSON) {
+        appendQueryHeader(ctx, out, id, query);
+        out += ",\"file_size\":" + std::to_string(code.file_size);
+        out += ",\"symbols\":" + std::to_string(code.symbol_count);
+        out += ",\"avg_length\":" + avg.str();
+        out += ",\"entropy\":" + entropy.str();
+        out += ",\"codes\":[";
+        for (int i = 0; i < code.symbol_count; ++i) {
+            if (i > 0) out += ',';
+            out += "{\"symbol\":" + std::to_string(code.symbols[i].symbol);
+            out += ",\"freq\":" + std::to_string(code.symbols[i].freq);
+            out += ",\"code\":\"" + std::string(code.symbols[i].code) + "\"}";
+        }
+        out += "]}\n";
+    } else {
+        std::string prefix = std::to_string(id) + '\t';
+        out += prefix + "shannon\t" + std::to_string(code.file_size) + '\t' + std::to_string(code.symbol_count) +
+               '\t' + avg.str() + '\t' + entropy.str() + '\n';
+        for (int i = 0; i < code.symbol_count; ++i) {
+            out += prefix + "code\t" + std::to_string(code.symbols[i].symbol) + '\t' +
+                   std::to_string(code.symbols[i].freq) + '\t' + code.symbols[i].code + '\n';
+        }
+    }
+}
+
+std::vector<Record*> queueToVector(const Queue& q) {
+    std::vector<Record*> records;
+    records.reserve(q.size);
+    for (QueueNode* node = q.front; node != nullptr; node = node->next) {
+        records.push_back(node->data);
+    }
+    return records;
+}
+
+PrefixCacheShard& prefixShard(BatchContext& ctx, const std::string& prefix) {
+    std::vector<PrefixCacheShard>& shards = ctx.shared->prefixShards;
+    return shards[std::hash<std::string>()(normalizeSearchPrefix(prefix)) % shards.size()];
+}
+
+const std::vector<Record*>& batchOrdering(BatchContext& ctx, SortOrder order) {
+    std::lock_guard<std::mutex> lock(ctx.shared->orderingsMutex);
+    auto it = ctx.shared->orderings.find(order);
+    if (it != ctx.shared->orderings.end()) return it->second;
+
+    std::vector<Record*>& records = ctx.shared->orderings[order];
+    records.reserve(ctx.db->size());
+    for (const Record& rec : *ctx.db) records.push_back(const_cast<Record*>(&rec));
+    sortRecords(records, order);
+    return records;
+}
+
+std::string readFieldText(std::istream& args) {
+    if (args.peek() == ' ') args.get();
+    std::string text;
+    std::getline(args, text);
+    return text;
+}
+
+bool clauseBitmap(BatchContext& ctx, const std::string& clause, RecordBitmap& result) {
+    std::istringstream args(clause);
+    std::string command;
+    args >> command;
+    const std::vector<Record>& db = *ctx.db;
+
+    if (command == "prefix" || command == "tree") {
+        std::string prefix;
+        int pages = 0;
+        if (!(args >> prefix) || (command == "tree" && !(args >> pages))) return false;
+        PrefixCacheShard& shard = prefixShard(ctx, prefix);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        PrefixCacheEntry& entry = cachedPrefixSearch(shard.cache, *ctx.indices, prefix);
+        if (command == "prefix") {
+            result = recordBitmapFromRecords(db, queueToVector(entry.queue));
+        } else {
+            result = recordBitmapFromRecords(db, searchInTreeByPages(cachedPrefixTree(shard.cache, entry), pages));
+        }
+    } else if (command == "find") {
+        std::string text;
+        std::getline(args >> std::ws, text);
+        if (text.empty()) return false;
+        Queue q = substringSearch(*ctx.textSearch, text);
+        result = recordBitmapFromRecords(db, queueToVector(q));
+        clearQueue(q);
+    } else if (command == "author" || command == "publisher") {
+        std::string text = readFieldText(args);
+        if (text.empty()) return false;
+        result = recordBitmapFromRecords(db, command == "author" ? lookupPrefix(*ctx.indexes, FIELD_AUTHOR, text)
+                                                                 : lookupEqual(*ctx.indexes, FIELD_PUBLISHER, text));
+    } else {
+        if (command == "scan" && !(args >> command)) return false;
+        RecordField field;
+        if (!parseRecordField(command, field)) return false;
+        const ColumnStore& columns = columnStore(*ctx.columns);
+        std::vector<uint64_t> words;
+        if (parseNumericField(command, field)) {
+            int low, high;
+            if (!(args >> low)) return false;
+            if (!(args >> high)) high = low;
+            scanRangeBitmap(columns, field, low, high, words);
+        } else {
+            std::string text = readFieldText(args);
+            bool prefix = !text.empty() && text.back() == '*';
+            if (prefix) text.pop_back();
+            scanTextBitmap(columns, field, text, prefix, words);
+        }
+        result = recordBitmapFromWords(words, columns.rows);
+    }
+    return true;
+}
+
+bool parseBitmapOp(const std::string& word, BitmapOp& op) {
+    if (word == "&&") op = BITMAP_AND;
+    else if (word == "||") op = BITMAP_OR;
+    else if (word == "&!") op = BITMAP_ANDNOT;
+    else return false;
+    return true;
+}
+
+bool readOptionalCount(std::istream& args, size_t fallback, size_t& count) {
+    std::string word;
+    count = fallback;
+    if (!(args >> word)) return true;
+    char* end;
+    errno = 0;
+    long long value = std::strtoll(word.c_str(), &end, 10);
+    if (*end != '\0' || value < 0 || errno == ERANGE) return false;
+    count = static_cast<size_t>(value);
+    return true;
+}
+
+bool nextQueryOperator(const std::string& text, size_t from, size_t& at, BitmapOp& op) {
+    for (size_t i = from; i + 2 <= text.size(); ++i) {
+        if ((i == 0 || text[i - 1] == ' ') && (i + 2 == text.size() || text[i + 2] == ' ') &&
+            parseBitmapOp(text.substr(i, 2), op)) {
+            at = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void executeBatchQuery(BatchContext& ctx, const std::string& line, long long id, std::string& out) {
+    INSTR_TIMER("batch.query");
+    std::istringstream args(line);
+    std::string command;
+    args >> command;
+
+    if (command == "prefix") {
+        std::string prefix;
+        if (!(args >> prefix)) {
+            emitError(ctx, out, id, line, "usage: prefix <letters>");
+            return;
+        }
+        PrefixCacheShard& shard = prefixShard(ctx, prefix);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        PrefixCacheEntry& entry = cachedPrefixSearch(shard.cache, *ctx.indices, prefix);
+        emitRecords(ctx, out, id, line, queueToVector(entry.queue));
+    } else if (command == "tree") {
+        std::string prefix;
+        std::vector<int> pages;
+        int value;
+        args >> prefix;
+        while (args >> value) pages.push_back(value);
+        if (prefix.empty() || pages.empty()) {
+            emitError(ctx, out, id, line, "usage: tree <letters> <pages> [pages...]");
+            return;
+        }
+        PrefixCacheShard& shard = prefixShard(ctx, prefix);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        PrefixCacheEntry& entry = cachedPrefixSearch(shard.cache, *ctx.indices, prefix);
+        OptimalSearchTree* tree = cachedPrefixTree(shard.cache, entry);
+        if (pages.size() == 1) emitRecords(ctx, out, id, line, searchInTreeByPages(tree, pages[0]));
+        else {
+            std::vector<std::vector<Record*>> groups;
+            for (const TreeLookup& found : searchInTreeByPagesBatch(tree, pages)) {
+                groups.emplace_back(found.records, found.records + found.count);
+            }
+            emitPagesGroups(ctx, out, id, line, pages, groups);
+        }
+    } else if ((command == "savetree" || command == "maptree") && !ctx.fileCommands) {
+        emitError(ctx, out, id, line, command + " is not available in server mode");
+    } else if (command == "savetree") {
+        std::string prefix, filename;
+        if (!(args >> prefix >> filename)) {
+            emitError(ctx, out, id, line, "usage: savetree <letters> <file>");
+            return;
+        }
+        PrefixCacheShard& shard = prefixShard(ctx, prefix);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        PrefixCacheEntry& entry = cachedPrefixSearch(shard.cache, *ctx.indices, prefix);
+        OptimalSearchTree* tree = cachedPrefixTree(shard.cache, entry);
+        dropMappedTree(ctx, filename);
+        if (!saveOptimalTree(tree, *ctx.db, filename)) {
+            emitError(ctx, out, id, line, "cannot write " + filename);
+            return;
+        }
+        emitTreeFile(ctx, out, id, line, tree);
+    } else if (command == "maptree") {
+        std::string filename;
+        std::vector<int> pages;
+        int value;
+        args >> filename;
+        while (args >> value) pages.push_back(value);
+        if (filename.empty() || pages.empty()) {
+            emitError(ctx, out, id, line, "usage: maptree <file> <pages> [pages...]");
+            return;
+        }
+        auto it = ctx.mappedTrees.find(filename);
+        if (it != ctx.mappedTrees.end() && !mappedTreeCurrent(it->second, filename)) {
+            dropMappedTree(ctx, filename);
+            it = ctx.mappedTrees.end();
+        }
+        if (it == ctx.mappedTrees.end()) {
+            MappedTree mapped;
+            if (!openMappedTree(mapped, filename, *ctx.db)) {
+                emitError(ctx, out, id, line, "cannot map tree " + filename);
+                return;
+            }
+            it = ctx.mappedTrees.emplace(filename, mapped).first;
+        }
+        if (pages.size() == 1) emitRecords(ctx, out, id, line, searchMappedTreeByPages(it->second, *ctx.db, pages[0]));
+        else {
+            std::vector<std::vector<Record*>> groups;
+            for (const MappedTreeLookup& found : searchMappedTreeByPagesBatch(it->second, pages)) {
+                groups.push_back(mappedLookupRecords(*ctx.db, found));
+            }
+            emitPagesGroups(ctx, out, id, line, pages, groups);
+        }
+    } else if (command == "find") {
+        std::string text;
+        std::getline(args >> std::ws, text);
+        if (text.empty()) {
+            emitError(ctx, out, id, line, "usage: find <text>");
+            return;
+        }
+        Queue q = substringSearch(*ctx.textSearch, text);
+        emitRecords(ctx, out, id, line, queueToVector(q));
+        clearQueue(q);
+    } else if (command == "fuzzy") {
+        std::string word;
+        int distance;
+        if (!(args >> word)) {
+            emitError(ctx, out, id, line, "usage: fuzzy <word> [distance]");
+            return;
+        }
+        if (!(args >> distance)) distance = defaultFuzzyDistance(word);
+        Queue q = fuzzySearch(*ctx.textSearch, word, std::max(0, std::min(distance, 3)));
+        emitRecords(ctx, out, id, line, queueToVector(q));
+        clearQueue(q);
+    } else if (command == "author") {
+        std::string prefix = readFieldText(args);
+        if (prefix.empty()) {
+            emitError(ctx, out, id, line, "usage: author <text>");
+            return;
+        }
+        emitRecords(ctx, out, id, line, lookupPrefix(*ctx.indexes, FIELD_AUTHOR, prefix));
+    } else if (command == "publisher") {
+        std::string name = readFieldText(args);
+        if (name.empty()) {
+            emitError(ctx, out, id, line, "usage: publisher <name>");
+            return;
+        }
+        emitRecords(ctx, out, id, line, lookupEqual(*ctx.indexes, FIELD_PUBLISHER, name));
+    } else if (command == "year" || command == "pages") {
+        int low, high;
+        if (!(args >> low)) {
+            emitError(ctx, out, id, line, "usage: " + command + " <from> [to]");
+            return;
+        }
+        if (!(args >> high)) high = low;
+        RecordField field = command == "year" ? FIELD_YEAR : FIELD_PAGES;
+        emitRecords(ctx, out, id, line, lookupRange(*ctx.indexes, field, low, high));
+    } else if (command == "scan") {
+        std::string name;
+        RecordField field;
+        if (!(args >> name) || !parseRecordField(name, field)) {
+            emitError(ctx, out, id, line, "usage: scan year|pages <from> [to] | scan author|title|publisher <text>[*]");
+            return;
+        }
+        std::vector<uint32_t> rows;
+        const ColumnStore& columns = columnStore(*ctx.columns);
+        if (parseNumericField(name, field)) {
+            int low, high;
+            if (!(args >> low)) {
+                emitError(ctx, out, id, line, "usage: scan year|pages <from> [to]");
+                return;
+            }
+            if (!(args >> high)) high = low;
+            scanRange(columns, field, low, high, rows);
+        } else {
+            std::string text = readFieldText(args);
+            bool prefix = !text.empty() && text.back() == '*';
+            if (prefix) text.pop_back();
+            scanText(columns, field, text, prefix, rows);
+        }
+        emitRecords(ctx, out, id, line, rowsToRecords(columns, rows));
+    } else if (command == "stat") {
+        std::string name, where, filterName;
+        RecordField field, filterField;
+        int low, high;
+        if (!(args >> name) || !parseNumericField(name, field)) {
+            emitError(ctx, out, id, line, "usage: stat year|pages [where year|pages <from> [to]]");
+            return;
+        }
+        const ColumnStore& columns = columnStore(*ctx.columns);
+        if (!(args >> where)) {
+            emitSummary(ctx, out, id, line, summarizeColumn(columns, field));
+            return;
+        }
+        if (where != "where" || !(args >> filterName >> low) || !parseNumericField(filterName, filterField)) {
+            emitError(ctx, out, id, line, "usage: stat year|pages [where year|pages <from> [to]]");
+            return;
+        }
+        if (!(args >> high)) high = low;
+        std::vector<uint32_t> rows;
+        scanRange(columns, filterField, low, high, rows);
+        emitSummary(ctx, out, id, line, summarizeRows(columns, field, rows));
+    } else if (command == "query") {
+        std::string text, clause;
+        std::getline(args, text);
+        RecordBitmap result;
+        BitmapOp op = BITMAP_OR;
+        bool first = true;
+        bool ok = true;
+        auto applyClause = [&] {
+            RecordBitmap part;
+            ok = ok && clauseBitmap(ctx, clause, part);
+            if (!ok) return;
+            result = first ? std::move(part) : combineRecordBitmaps(result, part, op);
+            first = false;
+            clause.clear();
+        };
+        size_t start = 0;
+        while (ok) {
+            size_t at;
+            BitmapOp next;
+            bool more = nextQueryOperator(text, start, at, next);
+            size_t end = more ? at : text.size();
+            if (more && end > start && text[end - 1] == ' ') --end;
+            clause = text.substr(start, end - start);
+            applyClause();
+            if (!more) break;
+            op = next;
+            start = at + 2;
+        }
+        if (!ok) {
+            emitError(ctx, out, id, line, "usage: query <clause> [&& | || | &! <clause>]...");
+            return;
+        }
+        emitRecords(ctx, out, id, line, recordBitmapRecords(*ctx.db, result));
+    } else if (command == "group") {
+        std::string name;
+        GroupKey key;
+        int prefixLetters;
+        size_t count;
+        if (!(args >> name) || !parseGroupKey(name, key, prefixLetters) || !readOptionalCount(args, 0, count)) {
+            emitError(ctx, out, id, line, "usage: group author|publisher|year|surname[:1-3] [count]");
+            return;
+        }
+        emitGroups(ctx, out, id, line,
+                   aggregateGroups(columnStore(*ctx.columns), key, prefixLetters, count, ctx.threads));
+    } else if (command == "order") {
+        std::string name;
+        SortOrder order;
+        size_t count;
+        if (!(args >> name) || !parseSortOrder(name, order) || !readOptionalCount(args, ctx.db->size(), count)) {
+            emitError(ctx, out, id, line,
+                      "usage: order surname|surname,year|author,title|publisher,pages|year,pages [count]");
+            return;
+        }
+        const std::vector<Record*>& records = batchOrdering(ctx, order);
+        count = std::min(count, records.size());
+        emitRecords(ctx, out, id, line, std::vector<Record*>(records.begin(), records.begin() + count));
+    } else if (command == "shannon") {
+        std::unique_lock<std::mutex> lock(ctx.shared->shannonMutex);
+        if (ctx.shared->shannon == nullptr) {
+            std::vector<char> buffer;
+            std::string failed;
+            if (!readWholeFiles(ctx.dbFiles, buffer, failed)) {
+                lock.unlock();
+                emitError(ctx, out, id, line, "cannot read " + failed);
+                return;
+            }
+            ShannonCode* code = new ShannonCode;
+            buildShannonCode(buffer.data(), buffer.size(), *code);
+            ctx.shared->shannon = code;
+        }
+        lock.unlock();
+        emitShannon(ctx, out, id, line);
+    } else {
+        emitError(ctx, out, id, line, "unknown command: " + command);
+    }
+}
+
+long long runBatch(BatchContext& ctx, std::istream& in, std::ostream& out) {
+    const size_t flushThreshold = 1 << 16;
+    std::string buffer;
+    std::string line;
+    long long id = 0;
+
+    while (std::getline(in, line)) {
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#') continue;
+        size_t end = line.find_last_not_of(" \t\r");
+        executeBatchQuery(ctx, line.substr(start, end - start + 1), ++id, buffer);
+
+        if (buffer.size() >= flushThreshold) {
+            out.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+    }
+    out.write(buffer.data(), buffer.size());
+    out.flush();
+    return id;
+}
@@ -0,0 +1,203 @@
+#include "bitmap.h"
+#include "instrument.h"
+#include <algorithm>
+#include <iterator>
+
+bool isDense(const BitmapContainer& c) {
+    return !c.words.empty();
+}
+
+bool testContainerBit(const BitmapContainer& c, uint16_t low) {
+    if (isDense(c)) return (c.words[low >> 6] >> (low & 63)) & 1;
+    return std::binary_search(c.array.begin(), c.array.end(), low);
+}
+
+void normalizeContainer(BitmapContainer& c) {
+    if (isDense(c) && c.cardinality <= BITMAP_ARRAY_LIMIT) {
+        c.array.clear();
+        c.array.reserve(c.cardinality);
+        for (size_t w = 0; w < BITMAP_CONTAINER_WORDS; ++w) {
+            uint64_t bits = c.words[w];
+            while (bits != 0) {
+                c.array.push_back(static_cast<uint16_t>(w * 64 + __builtin_ctzll(bits)));
+                bits &= bits - 1;
+            }
+        }
+        std::vector<uint64_t>().swap(c.words);
+    } else if (!isDense(c) && c.cardinality > BITMAP_ARRAY_LIMIT) {
+        c.words.assign(BITMAP_CONTAINER_WORDS, 0);
+        for (uint16_t low : c.array) c.words[low >> 6] |= uint64_t(1) << (low & 63);
+        std::vector<uint16_t>().swap(c.array);
+    }
+}
+
+std::vector<uint64_t> denseWords(const BitmapContainer& c) {
+    if (isDense(c)) return c.words;
+    std::vector<uint64_t> words(BITMAP_CONTAINER_WORDS, 0);
+    for (uint16_t low : c.array) words[low >> 6] |= uint64_t(1) << (low & 63);
+    return words;
+}
+
+uint32_t countWords(const std::vector<uint64_t>& words) {
+    uint32_t count = 0;
+    for (uint64_t bits : words) count += __builtin_popcountll(bits);
+    return count;
+}
+
+BitmapContainer combineContainers(const BitmapContainer& a, const BitmapContainer& b, BitmapOp op) {
+    BitmapContainer result{a.key, 0, {}, {}};
+
+    if (!isDense(a) && !isDense(b)) {
+        if (op == BITMAP_AND) {
+            std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                                  std::back_inserter(result.array));
+        } else if (op == BITMAP_OR) {
+            std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                           std::back_inserter(result.array));
+        } else {
+            std::set_difference(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                                std::back_inserter(result.array));
+        }
+        result.cardinality = result.array.size();
+    } else if (!isDense(a) && op != BITMAP_OR) {
+        for (uint16_t low : a.array) {
+            if (testContainerBit(b, low) == (op == BITMAP_AND)) result.array.push_back(low);
+        }
+        result.cardinality = result.array.size();
+    } else if (!isDense(b) && op == BITMAP_AND) {
+        for (uint16_t low : b.array) {
+            if (testContainerBit(a, low)) result.array.push_back(low);
+        }
+        result.cardinality = result.array.size();
+    } else {
+        result.words = denseWords(a);
+        if (isDense(b)) {
+            for (size_t w = 0; w < BITMAP_CONTAINER_WORDS; ++w) {
+                if (op == BITMAP_AND) result.words[w] &= b.words[w];
+                else if (op == BITMAP_OR) result.words[w] |= b.words[w];
+                else result.words[w] &= ~b.words[w];
+            }
+        } else {
+            for (uint16_t low : b.array) {
+                uint64_t bit = uint64_t(1) << (low & 63);
+                if (op == BITMAP_OR) result.words[low >> 6] |= bit;
+                else result.words[low >> 6] &= ~bit;
+            }
+        }
+        result.cardinality = countWords(result.words);
+    }
+
+    normalizeContainer(result);
+    return result;
+}
+
+RecordBitmap recordBitmapFromRows(const std::vector<uint32_t>& rows) {
+    INSTR_TIMER("bitmap.from_rows");
+    RecordBitmap bitmap;
+    for (uint32_t row : rows) {
+        uint16_t key = row >> 16;
+        if (bitmap.containers.empty() || bitmap.containers.back().key != key) {
+            bitmap.containers.push_back({key, 0, {}, {}});
+        }
+        BitmapContainer& c = bitmap.containers.back();
+        uint16_t low = row & 0xFFFF;
+        if (c.array.empty() || c.array.back() < low) {
+            c.array.push_back(low);
+            c.cardinality++;
+        }
+    }
+    for (BitmapContainer& c : bitmap.containers) normalizeContainer(c);
+    return bitmap;
+}
+
+RecordBitmap recordBitmapFromRecords(const std::vector<Record>& db, const std::vector<Record*>& records) {
+    std::vector<uint32_t> rows;
+    rows.reserve(records.size());
+    for (const Record* rec : records) rows.push_back(static_cast<uint32_t>(rec - db.data()));
+    std::sort(rows.begin(), rows.end());
+    return recordBitmapFromRows(rows);
+}
+
+RecordBitmap recordBitmapFromWords(const std::vector<uint64_t>& words, size_t rows) {
+    INSTR_TIMER("bitmap.from_words");
+    RecordBitmap bitmap;
+    size_t totalWords = std::min(words.size(), (rows + 63) / 64);
+    for (size_t first = 0; first < totalWords; first += BITMAP_CONTAINER_WORDS) {
+        size_t last = std::min(first + BITMAP_CONTAINER_WORDS, totalWords);
+        BitmapContainer c{static_cast<uint16_t>(first / BITMAP_CONTAINER_WORDS), 0, {}, {}};
+        c.words.assign(BITMAP_CONTAINER_WORDS, 0);
+        std::copy(words.begin() + first, words.begin() + last, c.words.begin());
+        if (last == totalWords && rows % 64 != 0) {
+            c.words[last - first - 1] &= (uint64_t(1) << (rows % 64)) - 1;
+        }
+        c.cardinality = countWords(c.words);
+        if (c.cardinality == 0) continue;
+        normalizeContainer(c);
+        bitmap.containers.push_back(std::move(c));
+    }
+    return bitmap;
+}
+
+RecordBitmap combineRecordBitmaps(const RecordBitmap& a, const RecordBitmap& b, BitmapOp op) {
+    INSTR_TIMER("bitmap.combine");
+    RecordBitmap result;
+    size_t i = 0, j = 0;
+    while (i < a.containers.size() || j < b.containers.size()) {
+        bool hasA = i < a.containers.size();
+        bool hasB = j < b.containers.size();
+        if (hasA && (!hasB || a.containers[i].key < b.containers[j].key)) {
+            if (op != BITMAP_AND) result.containers.push_back(a.containers[i]);
+            i++;
+        } else if (hasB && (!hasA || b.containers[j].key < a.containers[i].key)) {
+            if (op == BITMAP_OR) result.containers.push_back(b.containers[j]);
+            j++;
+        } else {
+            BitmapContainer c = combineContainers(a.containers[i], b.containers[j], op);
+            if (c.cardinality > 0) result.containers.push_back(std::move(c));
+            i++;
+            j++;
+        }
+    }
+    return result;
+}
+
+size_t recordBitmapCardinality(const RecordBitmap& bitmap) {
+    size_t count = 0;
+    for (const BitmapContainer& c : bitmap.containers) count += c.cardinality;
+    return count;
+}
+
+bool recordBitmapContains(const RecordBitmap& bitmap, uint32_t row) {
+    uint16_t key = row >> 16;
+    auto it = std::lower_bound(bitmap.containers.begin(), bitmap.containers.end(), key,
+        [](const BitmapContainer& c, uint16_t k) { return c.key < k; });
+    return it != bitmap.containers.end() && it->key == key && testContainerBit(*it, row & 0xFFFF);
+}
+
+void recordBitmapRows(const RecordBitmap& bitmap, std::vector<uint32_t>& rows) {
+    rows.clear();
+    rows.reserve(recordBitmapCardinality(bitmap));
+    for (const BitmapContainer& c : bitmap.containers) {
+        uint32_t high = uint32_t(c.key) << 16;
+        if (isDense(c)) {
+            for (size_t w = 0; w < BITMAP_CONTAINER_WORDS; ++w) {
+                uint64_t bits = c.words[w];
+                while (bits != 0) {
+                    rows.push_back(high | static_cast<uint32_t>(w * 64 + __builtin_ctzll(bits)));
+                    bits &= bits - 1;
+                }
+            }
+        } else {
+            for (uint16_t low : c.array) rows.push_back(high | low);
+        }
+    }
+}
+
+std::vector<Record*> recordBitmapRecords(const std::vector<Record>& db, const RecordBitmap& bitmap) {
+    std::vector<uint32_t> rows;
+    recordBitmapRows(bitmap, rows);
+    std::vector<Record*> records;
+    records.reserve(rows.size());
+    for (uint32_t row : rows) records.push_back(const_cast<Record*>(&db[row]));
+    return records;
+}
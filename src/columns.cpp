@@ -0,0 +1,257 @@
+#include "columns.h"
+#include "instrument.h"
+#include "simdscan.h"
+#include "transcode.h"
+#include <algorithm>
+#include <unordered_set>
+
+void initDictionaryColumn(DictionaryColumn& dict, size_t width) {
+    dict.encoded = false;
+    dict.width = width;
+    dict.size = 0;
+    dict.values.clear();
+    dict.codes.clear();
+}
+
+void initColumnStore(ColumnStore& store, const std::vector<Record>& db) {
+    store.db = &db;
+    store.rows = 0;
+    initDictionaryColumn(store.authorDict, AUTHOR_WIDTH);
+    initDictionaryColumn(store.publisherDict, PUBLISHER_WIDTH);
+}
+
+const char* rawFieldBytes(const Record& rec, RecordField field) {
+    return field == FIELD_AUTHOR ? rec.author : field == FIELD_TITLE ? rec.title : rec.publisher;
+}
+
+int findDictionaryCode(const DictionaryColumn& dict, const char* value) {
+    size_t low = 0, high = dict.size;
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        int cmp = memcmp(&dict.values[mid * dict.width], value, dict.width);
+        if (cmp == 0) return static_cast<int>(mid);
+        if (cmp < 0) low = mid + 1;
+        else high = mid;
+    }
+    return -1;
+}
+
+void rebuildDictionary(DictionaryColumn& dict, const std::vector<Record>& db, RecordField field) {
+    INSTR_TIMER("columns.dictionary");
+    std::unordered_set<std::string> distinct;
+    for (const Record& rec : db) {
+        distinct.emplace(rawFieldBytes(rec, field), dict.width);
+        if (distinct.size() > DICTIONARY_MAX_CODES) {
+            initDictionaryColumn(dict, dict.width);
+            return;
+        }
+    }
+
+    std::vector<std::string> sorted(distinct.begin(), distinct.end());
+    std::sort(sorted.begin(), sorted.end());
+    dict.encoded = true;
+    dict.size = sorted.size();
+    dict.values.assign(dict.size * dict.width + SCAN_PADDING, '\0');
+    for (size_t i = 0; i < dict.size; ++i) memcpy(&dict.values[i * dict.width], sorted[i].data(), dict.width);
+
+    dict.codes.resize(db.size());
+    for (size_t i = 0; i < db.size(); ++i) {
+        dict.codes[i] = static_cast<int16_t>(findDictionaryCode(dict, rawFieldBytes(db[i], field)));
+    }
+}
+
+bool extendDictionary(DictionaryColumn& dict, const std::vector<Record>& db, RecordField field, size_t from) {
+    dict.codes.resize(db.size());
+    for (size_t i = from; i < db.size(); ++i) {
+        int code = findDictionaryCode(dict, rawFieldBytes(db[i], field));
+        if (code < 0) return false;
+        dict.codes[i] = static_cast<int16_t>(code);
+    }
+    return true;
+}
+
+void fillTextColumn(std::vector<char>& column, const std::vector<Record>& db, RecordField field, size_t width,
+                    size_t from) {
+    column.resize(db.size() * width + SCAN_PADDING);
+    for (size_t i = from; i < db.size(); ++i) memcpy(&column[i * width], rawFieldBytes(db[i], field), width);
+}
+
+void appendEncodedColumn(ColumnStore& store, DictionaryColumn& dict, std::vector<char>& column, RecordField field,
+                         size_t from) {
+    const std::vector<Record>& db = *store.db;
+    bool wasEncoded = dict.encoded;
+    if (!wasEncoded || !extendDictionary(dict, db, field, from)) rebuildDictionary(dict, db, field);
+
+    if (dict.encoded) std::vector<char>().swap(column);
+    else fillTextColumn(column, db, field, dict.width, wasEncoded ? 0 : from);
+}
+
+void appendColumnRows(ColumnStore& store) {
+    const std::vector<Record>& db = *store.db;
+    size_t rows = db.size();
+    store.year.resize(rows);
+    store.pages.resize(rows);
+
+    for (size_t i = store.rows; i < rows; ++i) {
+        store.year[i] = db[i].year;
+        store.pages[i] = db[i].pages;
+    }
+    fillTextColumn(store.title, db, FIELD_TITLE, TITLE_WIDTH, store.rows);
+    appendEncodedColumn(store, store.authorDict, store.author, FIELD_AUTHOR, store.rows);
+    appendEncodedColumn(store, store.publisherDict, store.publisher, FIELD_PUBLISHER, store.rows);
+    store.rows = rows;
+}
+
+const ColumnStore& columnStore(ColumnStore& store) {
+    std::call_once(store.built, [&store] {
+        INSTR_TIMER("columns.build");
+        appendColumnRows(store);
+    });
+    if (store.rows != store.db->size()) appendColumnRows(store);
+    return store;
+}
+
+const int16_t* numericColumn(const ColumnStore& store, RecordField field) {
+    if (field == FIELD_YEAR) return store.year.data();
+    if (field == FIELD_PAGES) return store.pages.data();
+    return nullptr;
+}
+
+const char* textColumn(const ColumnStore& store, RecordField field, size_t& width) {
+    switch (field) {
+        case FIELD_AUTHOR: width = AUTHOR_WIDTH; return store.author.empty() ? nullptr : store.author.data();
+        case FIELD_TITLE: width = TITLE_WIDTH; return store.title.data();
+        case FIELD_PUBLISHER: width = PUBLISHER_WIDTH; return store.publisher.empty() ? nullptr : store.publisher.data();
+        default: width = 0; return nullptr;
+    }
+}
+
+const DictionaryColumn* dictionaryColumn(const ColumnStore& store, RecordField field) {
+    const DictionaryColumn* dict = field == FIELD_AUTHOR ? &store.authorDict
+                                 : field == FIELD_PUBLISHER ? &store.publisherDict : nullptr;
+    return dict != nullptr && dict->encoded ? dict : nullptr;
+}
+
+std::string dictionaryValue(const DictionaryColumn& dict, int code) {
+    return recordFieldText(&dict.values[code * dict.width], dict.width);
+}
+
+void countDictionaryCodes(const ColumnStore& store, RecordField field, std::vector<size_t>& counts) {
+    INSTR_TIMER("columns.count_codes");
+    counts.clear();
+    const DictionaryColumn* dict = dictionaryColumn(store, field);
+    if (dict == nullptr) return;
+    counts.assign(dict->size, 0);
+    for (size_t i = 0; i < store.rows; ++i) counts[dict->codes[i]]++;
+}
+
+size_t columnStoreBytes(const ColumnStore& store) {
+    size_t bytes = (store.year.capacity() + store.pages.capacity()) * sizeof(int16_t) +
+                   store.author.capacity() + store.title.capacity() + store.publisher.capacity();
+    for (const DictionaryColumn* dict : {&store.authorDict, &store.publisherDict}) {
+        bytes += dict->values.capacity() + dict->codes.capacity() * sizeof(int16_t);
+    }
+    return bytes;
+}
+
+void filterCodesBitmap(const DictionaryColumn& dict, size_t rows, const std::vector<uint64_t>& matches,
+                       std::vector<uint64_t>& bitmap) {
+    std::vector<uint32_t> codes;
+    bitmapToRows(matches, dict.size, codes);
+    if (codes.empty()) {
+        bitmap.assign((rows + 63) / 64, 0);
+    } else if (codes.back() - codes.front() + 1 == codes.size()) {
+        filterRangeBitmap(dict.codes.data(), rows, codes.front(), codes.back(), bitmap);
+    } else {
+        bitmap.assign((rows + 63) / 64, 0);
+        for (size_t row = 0; row < rows; ++row) {
+            int code = dict.codes[row];
+            bool match = (matches[code / 64] >> (code % 64)) & 1;
+            bitmap[row / 64] |= static_cast<uint64_t>(match) << (row % 64);
+        }
+    }
+}
+
+void scanRangeBitmap(const ColumnStore& store, RecordField field, int low, int high, std::vector<uint64_t>& bitmap) {
+    INSTR_TIMER("columns.scan");
+    bitmap.clear();
+    const int16_t* column = numericColumn(store, field);
+    if (column == nullptr) return;
+    filterRangeBitmap(column, store.rows, low, high, bitmap);
+}
+
+void scanRange(const ColumnStore& store, RecordField field, int low, int high, std::vector<uint32_t>& rows) {
+    std::vector<uint64_t> bitmap;
+    scanRangeBitmap(store, field, low, high, bitmap);
+    bitmapToRows(bitmap, store.rows, rows);
+}
+
+void scanTextBitmap(const ColumnStore& store, RecordField field, const std::string& value, bool prefix,
+                    std::vector<uint64_t>& bitmap) {
+    INSTR_TIMER("columns.scan");
+    bitmap.clear();
+    std::string key = utf8ToCP866(value);
+    if (!prefix) {
+        size_t end = key.find_last_not_of(' ');
+        key.resize(end == std::string::npos ? 0 : end + 1);
+    }
+
+    if (const DictionaryColumn* dict = dictionaryColumn(store, field)) {
+        std::vector<uint64_t> matches;
+        filterTextBitmap(dict->values.data(), dict->width, dict->size, key.data(), key.size(), prefix, matches);
+        filterCodesBitmap(*dict, store.rows, matches, bitmap);
+        return;
+    }
+
+    size_t width;
+    const char* column = textColumn(store, field, width);
+    if (column == nullptr) return;
+    filterTextBitmap(column, width, store.rows, key.data(), key.size(), prefix, bitmap);
+}
+
+void scanText(const ColumnStore& store, RecordField field, const std::string& value, bool prefix,
+              std::vector<uint32_t>& rows) {
+    std::vector<uint64_t> bitmap;
+    scanTextBitmap(store, field, value, prefix, bitmap);
+    bitmapToRows(bitmap, store.rows, rows);
+}
+
+ColumnSummary summarizeColumn(const ColumnStore& store, RecordField field) {
+    ColumnSummary summary{0, 0, 0, 0};
+    const int16_t* column = numericColumn(store, field);
+    if (column == nullptr || store.rows == 0) return summary;
+
+    long long sum = 0;
+    int low = column[0];
+    int high = column[0];
+    for (size_t i = 0; i < store.rows; ++i) {
+        int value = column[i];
+        sum += value;
+        low = std::min(low, value);
+        high = std::max(high, value);
+    }
+    return ColumnSummary{store.rows, sum, low, high};
+}
+
+ColumnSummary summarizeRows(const ColumnStore& store, RecordField field, const std::vector<uint32_t>& rows) {
+    ColumnSummary summary{0, 0, 0, 0};
+    const int16_t* column = numericColumn(store, field);
+    if (column == nullptr || rows.empty()) return summary;
+
+    summary.min = summary.max = column[rows[0]];
+    for (uint32_t row : rows) {
+        int value = column[row];
+        summary.sum += value;
+        summary.min = std::min(summary.min, value);
+        summary.max = std::max(summary.max, value);
+    }
+    summary.count = rows.size();
+    return summary;
+}
+
+std::vector<Record*> rowsToRecords(const ColumnStore& store, const std::vector<uint32_t>& rows) {
+    std::vector<Record*> records;
+    records.reserve(rows.size());
+    for (uint32_t row : rows) records.push_back(const_cast<Record*>(&(*store.db)[row]));
+    return records;
+}
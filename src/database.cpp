@@ -1,6 +1,9 @@
 #include "database.h"
+#include "instrument.h"
+#include "transcode.h"
 
 std::vector<Record> loadDatabase(const std::string& filename) {
+    INSTR_TIMER("database.load");
     std::vector<Record> db;
     std::ifstream file(filename, std::ios::binary);
     if (!file) {
@@ -15,66 +18,82 @@ std::vector<Record> loadDatabase(const std::string& filename) {
 }
 
 std::string convertToUTF8(const char* src, size_t len) {
-    iconv_t cd = iconv_open("UTF-8", "CP866");
-    if (cd == (iconv_t)-1) return std::string(src, len);
-
-    char* in = const_cast<char*>(src);
-    size_t inbytes = len;
-    std::string out_str(len * 2, '\0');
-    char* out = &out_str[0];
-    size_t outbytes = out_str.size();
-
-    iconv(cd, &in, &inbytes, &out, &outbytes);
-    iconv_close(cd);
-
-    out_str.resize(out_str.size() - outbytes);
+    INSTR_COUNT("database.convertToUTF8");
+    std::string out_str = cp866ToUTF8(src, len);
     size_t end = out_str.find_last_not_of(' ');
     if (end != std::string::npos) out_str.resize(end + 1);
     return out_str;
 }
 
-std::string extractSurname(const Record& rec) {
-    std::string title_str(rec.title, 32);
-    size_t end = title_str.find_last_not_of(' ');
-    if (end != std::string::npos) title_str.resize(end + 1);
+std::string recordFieldText(const char* src, size_t len) {
+    while (len > 0 && (src[len - 1] == ' ' || src[len - 1] == '\0')) len--;
+    return cp866ToUTF8(src, len);
+}
 
-    size_t pos1 = title_str.find('_');
-    size_t pos2 = std::string::npos;
-    if (pos1 != std::string::npos) {
-        pos2 = title_str.find('_', pos1 + 1);
+const char* recordFieldBytes(const Record& rec, RecordField field, size_t& len) {
+    const char* src;
+    switch (field) {
+        case FIELD_AUTHOR: src = rec.author; len = sizeof(rec.author); break;
+        case FIELD_TITLE: src = rec.title; len = sizeof(rec.title); break;
+        case FIELD_PUBLISHER: src = rec.publisher; len = sizeof(rec.publisher); break;
+        default: len = 0; return nullptr;
     }
+    while (len > 0 && (src[len - 1] == ' ' || src[len - 1] == '\0')) len--;
+    return src;
+}
+
+int recordFieldNumber(const Record& rec, RecordField field) {
+    return field == FIELD_YEAR ? rec.year : (field == FIELD_PAGES ? rec.pages : 0);
+}
 
-    if (pos2 == std::string::npos) {
-        pos1 = title_str.find(' ');
-        if (pos1 != std::string::npos) {
-            pos2 = title_str.find(' ', pos1 + 1);
+const char* findByte(const char* begin, const char* end, char c) {
+    const void* found = memchr(begin, c, end - begin);
+    return found != nullptr ? static_cast<const char*>(found) : nullptr;
+}
+
+const char* surnameBytes(const Record& rec, size_t& len) {
+    const char* begin = rec.title;
+    const char* end = rec.title + sizeof(rec.title);
+    const char* last = end;
+    while (last > begin && last[-1] == ' ') last--;
+    if (last == begin) last = end;
+
+    const char* pos1 = findByte(begin, last, '_');
+    const char* pos2 = pos1 != nullptr ? findByte(pos1 + 1, last, '_') : nullptr;
+
+    if (pos2 == nullptr) {
+        pos1 = findByte(begin, last, ' ');
+        if (pos1 != nullptr) {
+            pos2 = findByte(pos1 + 1, last, ' ');
         }
     }
 
-    if (pos2 == std::string::npos) return convertToUTF8(title_str.c_str(), title_str.size());
+    if (pos2 == nullptr) {
+        len = last - begin;
+        return begin;
+    }
 
-    std::string surname_raw = title_str.substr(pos2 + 1);
-    size_t start = surname_raw.find_first_not_of(' ');
-    if (start == std::string::npos) return "";
-    size_t surname_end = surname_raw.find_last_not_of(' ');
-    surname_raw = surname_raw.substr(start, surname_end - start + 1);
+    const char* start = pos2 + 1;
+    while (start < last && *start == ' ') start++;
+    len = last - start;
+    return start;
+}
 
-    return convertToUTF8(surname_raw.c_str(), surname_raw.size());
+std::string extractSurname(const Record& rec) {
+    INSTR_COUNT("database.extractSurname");
+    size_t len;
+    const char* surname = surnameBytes(rec, len);
+    return cp866ToUTF8(surname, len);
 }
 
 int customCompare(const std::string& a, const std::string& b) {
-    try {
-        std::locale loc("ru_RU.UTF-8");
-        const std::collate<char>& col = std::use_facet<std::collate<char>>(loc);
-        return col.compare(a.data(), a.data() + a.size(), b.data(), b.data() + b.size());
-    } catch (...) {
-        size_t len = std::min(a.size(), b.size());
-        for (size_t i = 0; i < len; ++i) {
-            if (static_cast<unsigned char>(a[i]) < static_cast<unsigned char>(b[i])) return -1;
-            if (static_cast<unsigned char>(a[i]) > static_cast<unsigned char>(b[i])) return 1;
-        }
-        if (a.size() < b.size()) return -1;
-        if (a.size() > b.size()) return 1;
-        return 0;
+    INSTR_COUNT("database.customCompare");
+    size_t len = std::min(a.size(), b.size());
+    for (size_t i = 0; i < len; ++i) {
+        if (static_cast<unsigned char>(a[i]) < static_cast<unsigned char>(b[i])) return -1;
+        if (static_cast<unsigned char>(a[i]) > static_cast<unsigned char>(b[i])) return 1;
     }
+    if (a.size() < b.size()) return -1;
+    if (a.size() > b.size()) return 1;
+    return 0;
 }
\ No newline at end of file
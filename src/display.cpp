@@ -1,59 +1,80 @@
 #include "display.h"
+#include "instrument.h"
 #include "search.h"
+#include "render.h"
+#include "textcache.h"
+#include "aggregate.h"
 #include <random>
 #include <cstdlib>
 #include <iostream>
 #include <string>
 #include <algorithm>
+#include <sstream>
 #include "shannon.h"
 
+std::string pageStatus(int page, int total_pages) {
+    std::string status = "Страница ";
+    appendPaddedLeft(status, std::to_string(page + 1), 2);
+    status += "/";
+    appendPaddedLeft(status, std::to_string(total_pages), 2);
+    return status;
+}
+
 void displayPage(const std::vector<Record*>& data, int page, int per_page, const std::string& title, bool show_special_options) {
-    system("clear");
+    std::string screen;
+    beginScreen(screen);
 
     int start = page * per_page;
     int end = std::min(start + per_page, static_cast<int>(data.size()));
 
-    std::cout << "╔═══════════════════════════════════════════════════════════════════════════╗\n";
-    std::cout << "║ " << std::setw(75) << std::left << title << "║\n";
-    std::cout << "╠═══════════════════════════════════════════════════════════════════════════╣\n";
-    std::cout << "║ Автор         Заглавие                     Издательство     Год   Стр   ║\n";
-    std::cout << "╠═══════════════════════════════════════════════════════════════════════════╣\n";
+    appendRecordTableHeader(screen, title);
 
     for (int idx = start; idx < end; ++idx) {
-        Record* rec = data[idx];
-        std::string author = convertToUTF8(rec->author, 12);
-        std::string title_str = convertToUTF8(rec->title, 32);
-        std::string publisher = convertToUTF8(rec->publisher, 16);
-        
-        std::cout << "║ " << std::left << std::setw(12) << author << " "
-                  << std::setw(32) << title_str << " "
-                  << std::setw(16) << publisher << " "
-                  << std::setw(4) << rec->year << " "
-                  << std::setw(4) << rec->pages << " ║\n";
+        appendRecordRow(screen, data[idx]);
     }
 
-    for (int i = end - start; i < per_page; i++) {
-        std::cout << "║                                                                             ║\n";
-    }
+    appendEmptyRows(screen, per_page - (end - start));
+    appendBorder(screen, BORDER_MIDDLE);
 
-    std::cout << "╠═══════════════════════════════════════════════════════════════════════════╣\n";
-    
     int total_pages = (data.size() + per_page - 1) / per_page;
-    
+
     if (show_special_options) {
-        std::cout << "║ Страница " << std::setw(2) << (page + 1) << "/" << std::setw(2) << total_pages 
-                  << " | N-след | P-пред | B-назад | R-случайная | I-по номеру | A-вся БД ║\n";
+        appendBoxLine(screen, pageStatus(page, total_pages) +
+                              " | N-след | P-пред | B-назад | R-случайная | I-по номеру | A-вся БД");
     } else {
-        std::cout << "║ Страница " << std::setw(2) << (page + 1) << "/" << std::setw(2) << total_pages 
-                  << " | N - след. | P - пред. | B - назад | Всего: " << std::setw(4) << data.size() << " ║\n";
+        std::string total;
+        appendPaddedLeft(total, std::to_string(data.size()), 4);
+        appendBoxLine(screen, pageStatus(page, total_pages) +
+                              " | N - след. | P - пред. | B - назад | Всего: " + total);
+    }
+
+    appendBorder(screen, BORDER_BOTTOM);
+    screen += "Выбор: ";
+    flushScreen(screen);
+}
+
+void displayWholeDatabase(const std::vector<Record*>& data) {
+    std::string screen;
+    beginScreen(screen);
+    appendBorder(screen, BORDER_TOP);
+    appendCenteredBoxLine(screen, "ВСЯ ОТСОРТИРОВАННАЯ БАЗА ДАННЫХ");
+    appendBorder(screen, BORDER_MIDDLE);
+    appendBoxLine(screen, "Автор        Заглавие                         Издательство     Год  Стр");
+    appendBorder(screen, BORDER_MIDDLE);
+
+    for (size_t i = 0; i < data.size(); ++i) {
+        appendRecordRow(screen, data[i]);
     }
-    
-    std::cout << "╚═══════════════════════════════════════════════════════════════════════════╝\n";
-    
-    std::cout << "Выбор: ";
+
+    appendBorder(screen, BORDER_MIDDLE);
+    appendBoxLine(screen, "Всего записей: " + std::to_string(data.size()));
+    appendBorder(screen, BORDER_BOTTOM);
+    screen += "\nНажмите Enter для возврата...";
+    flushScreen(screen);
 }
 
-void displayInteractive(const std::vector<Record*>& data, const std::string& title, bool is_sorted_view) {
+void displayInteractive(const std::vector<Record*>& data, const std::string& title, bool is_sorted_view,
+                        IncrementalSort* lazy) {
     if (data.empty()) {
         std::cout << "База данных пуста.\n";
         std::cout << "Нажмите Enter...";
@@ -69,6 +90,7 @@ void displayInteractive(const std::vector<Record*>& data, const std::string& tit
     std::mt19937 gen(rd());
 
     while (true) {
+        if (lazy) ensureSortedRange(*lazy, current_page * per_page, (current_page + 1) * per_page);
         displayPage(data, current_page, per_page, title, is_sorted_view);
 
         std::string input;
@@ -77,7 +99,7 @@ void displayInteractive(const std::vector<Record*>& data, const std::string& tit
         std::transform(input.begin(), input.end(), input.begin(), ::tolower);
 
         if (input == "b") {
-            system("clear");
+            clearScreen();
             break;
         } else if (input == "n" || input.empty()) {
             if (current_page < total_pages - 1) ++current_page;
@@ -86,22 +108,22 @@ void displayInteractive(const std::vector<Record*>& data, const std::string& tit
         } else if (is_sorted_view && input == "r") {
             std::uniform_int_distribution<> dis(0, data.size() - 1);
             int idx = dis(gen);
+            if (lazy) ensureSortedRange(*lazy, idx, idx + 1);
             std::vector<Record*> single = {data[idx]};
-            
-            system("clear");
-            displayPage(single, 0, 1, "Случайная запись: " + convertToUTF8(data[idx]->title, 32), false);
+
+            displayPage(single, 0, 1, "Случайная запись: " + cachedRecordText(data[idx])->title, false);
             std::cout << "\nНажмите Enter...";
             std::cin.get();
         } else if (is_sorted_view && input == "i") {
             int num;
-            system("clear");
+            clearScreen();
             std::cout << "Введите номер записи (0 — " << data.size() - 1 << "): ";
             std::cin >> num;
             std::cin.ignore();
             if (num >= 0 && num < static_cast<int>(data.size())) {
+                if (lazy) ensureSortedRange(*lazy, num, num + 1);
                 std::vector<Record*> single = {data[num]};
-                system("clear");
-                displayPage(single, 0, 1, "Запись №" + std::to_string(num) + ": " + convertToUTF8(data[num]->title, 32), false);
+                displayPage(single, 0, 1, "Запись №" + std::to_string(num) + ": " + cachedRecordText(data[num])->title, false);
                 std::cout << "\nНажмите Enter...";
                 std::cin.get();
             } else {
@@ -110,46 +132,28 @@ void displayInteractive(const std::vector<Record*>& data, const std::string& tit
                 std::cin.get();
             }
         } else if (is_sorted_view && input == "a") {
-            system("clear");
-            std::cout << "╔═══════════════════════════════════════════════════════════════════════════╗\n";
-            std::cout << "║                 ВСЯ ОТСОРТИРОВАННАЯ БАЗА ДАННЫХ                          ║\n";
-            std::cout << "╠═══════════════════════════════════════════════════════════════════════════╣\n";
-            std::cout << "║ Автор         Заглавие                     Издательство     Год   Стр   ║\n";
-            std::cout << "╠═══════════════════════════════════════════════════════════════════════════╣\n";
-            
-            for (size_t i = 0; i < data.size(); ++i) {
-                Record* rec = data[i];
-                std::string author = convertToUTF8(rec->author, 12);
-                std::string title_str = convertToUTF8(rec->title, 32);
-                std::string publisher = convertToUTF8(rec->publisher, 16);
-                
-                std::cout << "║ " << std::left << std::setw(12) << author << " "
-                          << std::setw(32) << title_str << " "
-                          << std::setw(16) << publisher << " "
-                          << std::setw(4) << rec->year << " "
-                          << std::setw(4) << rec->pages << " ║\n";
-            }
-            
-            std::cout << "╠═══════════════════════════════════════════════════════════════════════════╣\n";
-            std::cout << "║ Всего записей: " << std::setw(60) << std::left << data.size() << "║\n";
-            std::cout << "╚═══════════════════════════════════════════════════════════════════════════╝\n";
-            std::cout << "\nНажмите Enter для возврата...";
+            if (lazy) ensureSortedRange(*lazy, 0, data.size());
+            displayWholeDatabase(data);
             std::cin.get();
         }
     }
 }
 
-void displayQueueWithTreeOption(const Queue& q, const std::string& title, OptimalSearchTree*& optimalTree) {
+void displayQueueWithTreeOption(PrefixCache& cache, PrefixCacheEntry& entry, const std::string& title) {
+    const Queue& q = entry.queue;
+    std::string screen;
+
     if (q.size == 0) {
-        system("clear");
-        std::cout << "╔═══════════════════════════════════════════════════════════════════════════╗\n";
-        std::cout << "║ " << std::setw(75) << std::left << title << "║\n";
-        std::cout << "╠═══════════════════════════════════════════════════════════════════════════╣\n";
-        std::cout << "║                                                                            ║\n";
-        std::cout << "║                          Очередь пуста.                                  ║\n";
-        std::cout << "║                                                                            ║\n";
-        std::cout << "╚═══════════════════════════════════════════════════════════════════════════╝\n";
-        std::cout << "\nНажмите Enter...";
+        beginScreen(screen);
+        appendBorder(screen, BORDER_TOP);
+        appendBoxLine(screen, title);
+        appendBorder(screen, BORDER_MIDDLE);
+        appendBoxLine(screen, "");
+        appendCenteredBoxLine(screen, "Очередь пуста.");
+        appendBoxLine(screen, "");
+        appendBorder(screen, BORDER_BOTTOM);
+        screen += "\nНажмите Enter...";
+        flushScreen(screen);
         std::cin.get();
         return;
     }
@@ -157,140 +161,316 @@ void displayQueueWithTreeOption(const Queue& q, const std::string& title, Optima
     const int per_page = 20;
     int total_pages = (q.size + per_page - 1) / per_page;
     int current_page = 0;
-    
+
     while (true) {
-        system("clear");
-        std::cout << "╔═══════════════════════════════════════════════════════════════════════════╗\n";
-        std::cout << "║ " << std::setw(75) << std::left << title << "║\n";
-        std::cout << "╠═══════════════════════════════════════════════════════════════════════════╣\n";
-        std::cout << "║ Автор         Заглавие                     Издательство     Год   Стр   ║\n";
-        std::cout << "╠═══════════════════════════════════════════════════════════════════════════╣\n";
-        
+        beginScreen(screen);
+        appendRecordTableHeader(screen, title);
+
         QueueNode* current = q.front;
         int counter = 0;
         int skipped = current_page * per_page;
-        
+
         while (current != nullptr && skipped > 0) {
             current = current->next;
             skipped--;
         }
-        
+
         while (current != nullptr && counter < per_page) {
-            Record* rec = current->data;
-            std::string author = convertToUTF8(rec->author, 12);
-            std::string title_str = convertToUTF8(rec->title, 32);
-            std::string publisher = convertToUTF8(rec->publisher, 16);
-            
-            std::cout << "║ " << std::left << std::setw(12) << author << " "
-                      << std::setw(32) << title_str << " "
-                      << std::setw(16) << publisher << " "
-                      << std::setw(4) << rec->year << " "
-                      << std::setw(4) << rec->pages << " ║\n";
-            
+            appendRecordRow(screen, current->data);
             current = current->next;
             counter++;
         }
-        
-        for (int i = counter; i < per_page; i++) {
-            std::cout << "║                                                                             ║\n";
-        }
-        
-        std::cout << "╠═══════════════════════════════════════════════════════════════════════════╣\n";
-        
-        std::cout << "║ Страница " << std::setw(2) << (current_page + 1) << "/" << std::setw(2) << total_pages 
-                  << " | N - след. | P - пред. | B - назад | T - обход дерева A1 ║\n";
-        
-        std::cout << "╚═══════════════════════════════════════════════════════════════════════════╝\n";
-        std::cout << "Выбор: ";
-        
+
+        appendEmptyRows(screen, per_page - counter);
+        appendBorder(screen, BORDER_MIDDLE);
+        appendBoxLine(screen, pageStatus(current_page, total_pages) +
+                              " | N - след. | P - пред. | B - назад | T - обход дерева A1");
+        appendBorder(screen, BORDER_BOTTOM);
+        screen += "Выбор: ";
+        flushScreen(screen);
+
         std::string input;
         std::getline(std::cin, input);
-        
+
         std::transform(input.begin(), input.end(), input.begin(), ::tolower);
-        
+
         if (input == "t") {
-            if (optimalTree != nullptr) {
-                clearOptimalTree(optimalTree);
-                optimalTree = nullptr;
-            }
-            
-            optimalTree = buildOptimalSearchTreeA1(const_cast<Queue&>(q));
-            
+            OptimalSearchTree* optimalTree = cachedPrefixTree(cache, entry);
+
             if (optimalTree != nullptr) {
                 displayTreeTraversals(optimalTree);
             }
             return;
-        } 
+        }
         else if (input == "b") {
             return;
-        } 
+        }
         else if (input == "n") {
             if (current_page < total_pages - 1) current_page++;
-        } 
+        }
         else if (input == "p") {
             if (current_page > 0) current_page--;
         }
     }
 }
 
-void displayMainMenu(const std::vector<Record>& original, 
+void displayFieldFilter(SecondaryIndexes& indexes) {
+    clearScreen();
+    std::cout << "Поле: 1 - автор (начало), 2 - издательство, 3 - год, 4 - страницы: ";
+    std::string field;
+    std::getline(std::cin, field);
+
+    std::vector<Record*> results;
+    std::string title;
+    if (field == "1" || field == "2") {
+        std::string value;
+        std::cout << (field == "1" ? "Начало поля автора: " : "Издательство: ");
+        std::getline(std::cin, value);
+        if (field == "1") {
+            results = lookupPrefix(indexes, FIELD_AUTHOR, value);
+            title = "Автор: " + value + "...";
+        } else {
+            results = lookupEqual(indexes, FIELD_PUBLISHER, value);
+            title = "Издательство: " + value;
+        }
+    } else if (field == "3" || field == "4") {
+        int low, high;
+        std::cout << "Диапазон (от до): ";
+        std::cin >> low >> high;
+        std::cin.ignore();
+        RecordField recordField = field == "3" ? FIELD_YEAR : FIELD_PAGES;
+        results = lookupRange(indexes, recordField, low, high);
+        title = (field == "3" ? "Год: " : "Страниц: ") + std::to_string(low) + " — " + std::to_string(high);
+    } else {
+        return;
+    }
+
+    if (results.empty()) {
+        std::cout << "\nЗаписей не найдено.\n";
+        std::cout << "\nНажмите Enter...";
+        std::cin.get();
+        return;
+    }
+    displayInteractive(results, title + " (найдено " + std::to_string(results.size()) + ")", false);
+}
+
+void displayTextSearch(TextSearchIndex& textSearch) {
+    clearScreen();
+    std::string text;
+    std::cout << "Текст для поиска (~слово — поиск с опечатками): ";
+    std::getline(std::cin, text);
+    if (text.empty()) return;
+
+    bool fuzzy = text[0] == '~';
+    Queue found;
+    std::string title;
+    if (fuzzy) {
+        text.erase(0, 1);
+        found = fuzzySearch(textSearch, text, defaultFuzzyDistance(text));
+        title = "Похожие на '" + text + "'";
+    } else {
+        found = substringSearch(textSearch, text);
+        title = "Содержат '" + text + "'";
+    }
+
+    if (found.size == 0) {
+        std::cout << "\nЗаписей не найдено.\n";
+        std::cout << "\nНажмите Enter...";
+        std::cin.get();
+    } else {
+        std::vector<Record*> results;
+        for (QueueNode* node = found.front; node != nullptr; node = node->next) results.push_back(node->data);
+        displayInteractive(results, title + " (найдено " + std::to_string(results.size()) + ")", false);
+    }
+    clearQueue(found);
+}
+
+void displayGroupStatistics(ColumnStore& columns) {
+    clearScreen();
+    std::cout << "Группировать: 1 - издательство, 2 - автор, 3 - год (гистограмма), 4 - начало фамилии: ";
+    std::string choice;
+    std::getline(std::cin, choice);
+
+    GroupKey key;
+    int prefixLetters = AGGREGATE_MAX_PREFIX;
+    std::string title;
+    if (choice == "1") {
+        key = GROUP_PUBLISHER;
+        title = "Издательство";
+    } else if (choice == "2") {
+        key = GROUP_AUTHOR;
+        title = "Автор";
+    } else if (choice == "3") {
+        key = GROUP_YEAR;
+        title = "Год";
+    } else if (choice == "4") {
+        key = GROUP_SURNAME;
+        title = "Фамилия";
+        std::cout << "Число первых букв (1-" << AGGREGATE_MAX_PREFIX << "): ";
+        std::string letters;
+        std::getline(std::cin, letters);
+        if (letters.size() == 1 && letters[0] >= '1' && letters[0] <= '0' + AGGREGATE_MAX_PREFIX) {
+            prefixLetters = letters[0] - '0';
+        }
+    } else {
+        return;
+    }
+
+    std::vector<GroupAggregate> groups = aggregateGroups(columnStore(columns), key, prefixLetters, 0, 0);
+    size_t largest = 0;
+    for (const GroupAggregate& group : groups) largest = std::max(largest, group.pages.count);
+
+    const int per_page = 20;
+    int total_pages = std::max<int>(1, (groups.size() + per_page - 1) / per_page);
+    int current_page = 0;
+    std::string screen;
+    while (true) {
+        beginScreen(screen);
+        appendBorder(screen, BORDER_TOP);
+        appendBoxLine(screen, "Статистика: " + title + " (групп: " + std::to_string(groups.size()) + ")");
+        appendBorder(screen, BORDER_MIDDLE);
+        std::string header;
+        appendPadded(header, title, 16);
+        header += key == GROUP_YEAR ? " Книг  Гистограмма" : " Книг   Стр: мин  макс  средн";
+        appendBoxLine(screen, header);
+        appendBorder(screen, BORDER_MIDDLE);
+
+        int counter = 0;
+        for (size_t i = current_page * per_page; i < groups.size() && counter < per_page; ++i, ++counter) {
+            const ColumnSummary& pages = groups[i].pages;
+            std::string row;
+            appendPadded(row, groups[i].value, 16);
+            row += ' ';
+            appendPaddedLeft(row, std::to_string(pages.count), 4);
+            row += "  ";
+            if (key == GROUP_YEAR) {
+                size_t bar = largest > 0 ? (pages.count * 50 + largest - 1) / largest : 0;
+                for (size_t b = 0; b < bar; ++b) row += "█";
+            } else {
+                std::ostringstream avg;
+                avg << std::fixed << std::setprecision(1) << averagePages(pages);
+                appendPaddedLeft(row, std::to_string(pages.min), 9);
+                appendPaddedLeft(row, std::to_string(pages.max), 6);
+                appendPaddedLeft(row, avg.str(), 7);
+            }
+            appendBoxLine(screen, row);
+        }
+
+        appendEmptyRows(screen, per_page - counter);
+        appendBorder(screen, BORDER_MIDDLE);
+        appendBoxLine(screen, pageStatus(current_page, total_pages) + " | N - след. | P - пред. | B - назад");
+        appendBorder(screen, BORDER_BOTTOM);
+        screen += "Выбор: ";
+        flushScreen(screen);
+
+        std::string input;
+        std::getline(std::cin, input);
+        std::transform(input.begin(), input.end(), input.begin(), ::tolower);
+        if (input == "b") {
+            return;
+        } else if (input == "n") {
+            if (current_page < total_pages - 1) current_page++;
+        } else if (input == "p") {
+            if (current_page > 0) current_page--;
+        }
+    }
+}
+
+void waitForSortedIndex(const std::shared_future<void>& sortedReady) {
+    if (sortedReady.wait_for(std::chrono::seconds(0)) == std::future_status::ready) return;
+    clearScreen();
+    std::cout << "Упорядочение базы данных..." << std::flush;
+    sortedReady.wait();
+}
+
+void displayMainMenu(const std::vector<Record>& original,
                      const std::vector<Record*>& sorted_indices,
-                     Queue*& currentQueue,
-                     OptimalSearchTree*& optimalTree) {
+                     const std::shared_future<void>& sortedReady,
+                     SecondaryIndexes& indexes,
+                     TextSearchIndex& textSearch,
+                     ColumnStore& columns,
+                     PrefixCache& prefixCache,
+                     const std::vector<std::string>& dbFiles) {
     int choice;
+    std::string screen;
+    IncrementalSort lazySorted;
+    bool lazyStarted = false;
     do {
-        system("clear");
-        std::cout << "╔══════════════════════════════════════════════════════════════════════════╗\n";
-        std::cout << "║                               ГЛАВНОЕ МЕНЮ                              ║\n";
-        std::cout << "╠══════════════════════════════════════════════════════════════════════════╣\n";
-        std::cout << "║ 1. Исходная БД                                                         ║\n";
-        std::cout << "║ 2. Отсортированная БД                                                  ║\n";
-        std::cout << "║ 3. Двоичный поиск по фамилии (первые 3 буквы)                          ║\n";
-        std::cout << "║ 4. Кодирование Шеннона                                                 ║\n";
-        std::cout << "║ 0. Выход                                                               ║\n";
-        std::cout << "╚══════════════════════════════════════════════════════════════════════════╝\n";
-        std::cout << "Ваш выбор: ";
+        beginScreen(screen);
+        appendBorder(screen, BORDER_TOP);
+        appendCenteredBoxLine(screen, "ГЛАВНОЕ МЕНЮ");
+        appendBorder(screen, BORDER_MIDDLE);
+        appendBoxLine(screen, "1. Исходная БД");
+        appendBoxLine(screen, "2. Отсортированная БД");
+        appendBoxLine(screen, "3. Двоичный поиск по фамилии (первые 3 буквы)");
+        appendBoxLine(screen, "4. Кодирование Шеннона");
+        appendBoxLine(screen, "5. Фильтр по автору, издательству, году или страницам");
+        appendBoxLine(screen, "6. Поиск по подстроке или с опечатками (автор, заглавие)");
+        appendBoxLine(screen, "7. Статистика по издательствам, авторам, годам и фамилиям");
+        appendBoxLine(screen, "0. Выход");
+        appendBorder(screen, BORDER_BOTTOM);
+        screen += "Ваш выбор: ";
+        flushScreen(screen);
         std::cin >> choice;
         std::cin.ignore();
 
         if (choice == 1) {
+            INSTR_TIMER("menu.original");
             std::vector<Record*> orig_indices;
             for (const auto& rec : original) orig_indices.push_back(const_cast<Record*>(&rec));
             displayInteractive(orig_indices, "Исходная база данных", false);
-        } 
+        }
         else if (choice == 2) {
-            displayInteractive(sorted_indices, "Отсортированная база данных", true);
-        } 
+            INSTR_TIMER("menu.sorted");
+            if (!lazyStarted && sortedReady.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+                displayInteractive(sorted_indices, "Отсортированная база данных", true);
+            } else {
+                if (!lazyStarted) {
+                    std::vector<Record*> orig_indices;
+                    for (const auto& rec : original) orig_indices.push_back(const_cast<Record*>(&rec));
+                    initIncrementalSort(lazySorted, orig_indices);
+                    lazyStarted = true;
+                }
+                displayInteractive(lazySorted.indices, "Отсортированная база данных", true, &lazySorted);
+            }
+        }
         else if (choice == 3) {
-            system("clear");
+            INSTR_TIMER("menu.search");
+            clearScreen();
             std::string prefix;
             std::cout << "Введите первые 3 буквы фамилии: ";
             std::getline(std::cin, prefix);
-            
-            clearQueue(*currentQueue);
-            
-            Queue tempQueue = binarySearchWithIndexing(sorted_indices, prefix);
-            
-            QueueNode* current = tempQueue.front;
-            while (current != nullptr) {
-                enqueue(*currentQueue, current->data);
-                current = current->next;
-            }
-            
-            if (currentQueue->size == 0) {
+            waitForSortedIndex(sortedReady);
+
+            PrefixCacheEntry& entry = cachedPrefixSearch(prefixCache, sorted_indices, prefix);
+
+            if (entry.queue.size == 0) {
                 std::cout << "\nЗаписей с префиксом '" << prefix << "' не найдено.\n";
                 std::cout << "\nНажмите Enter...";
                 std::cin.get();
             } else {
-                displayQueueWithTreeOption(*currentQueue, 
-                                          "РЕЗУЛЬТАТЫ ПОИСКА ПО КЛЮЧУ (очередь)", 
-                                          optimalTree);
+                displayQueueWithTreeOption(prefixCache, entry,
+                                          "РЕЗУЛЬТАТЫ ПОИСКА ПО КЛЮЧУ (очередь)");
             }
-        } 
+        }
         else if (choice == 4) {
-            shannonCoding("testBase1.dat");
+            INSTR_TIMER("menu.shannon");
+            shannonCoding(dbFiles);
+        }
+        else if (choice == 5) {
+            INSTR_TIMER("menu.filter");
+            displayFieldFilter(indexes);
+        }
+        else if (choice == 6) {
+            INSTR_TIMER("menu.textsearch");
+            waitForSortedIndex(sortedReady);
+            displayTextSearch(textSearch);
+        }
+        else if (choice == 7) {
+            INSTR_TIMER("menu.statistics");
+            displayGroupStatistics(columns);
         }
     } while (choice != 0);
 
-    system("clear");
-}
\ No newline at end of file
+    clearScreen();
+}
@@ -0,0 +1,224 @@
+#include "generator.h"
+#include "transcode.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+static const char* const kSurnameStems[] = {
+    "Абрамов", "Алексеев", "Андреев", "Архипов", "Ахмедов", "Баранов", "Батыров", "Беляев",
+    "Борисов", "Васильев", "Виноградов", "Волков", "Воробьев", "Гаврилов", "Гедеонов", "Герасимов",
+    "Голубев", "Григорьев", "Давыдов", "Демьянов", "Денисов", "Дмитриев", "Евграфов", "Егоров",
+    "Жаков", "Жуков", "Зайцев", "Захаров", "Зосимов", "Иванов", "Ильин", "Казаков",
+    "Калинин", "Киселев", "Климов", "Ковалев", "Козлов", "Комаров", "Королев", "Кузнецов",
+    "Лебедев", "Максимов", "Медведев", "Михайлов", "Морозов", "Муамаров", "Назаров", "Никитин",
+    "Новиков", "Орлов", "Осипов", "Остапов", "Павлов", "Патриков", "Петров", "Поляков",
+    "Попов", "Романов", "Сабиров", "Семенов", "Сергеев", "Смирнов", "Соколов", "Соловьев",
+    "Степанов", "Тарасов", "Тимофеев", "Тихонов", "Уваров", "Устинов", "Федоров", "Феофанов",
+    "Филиппов", "Фролов", "Хасанов", "Харитонов", "Цветков", "Чернов", "Шаров", "Шестаков",
+    "Щербаков", "Юдин", "Яковлев", "Ярославцев"
+};
+
+static const char* const kMaleNames[] = {
+    "Александр", "Алексей", "Андрей", "Борис", "Вадим", "Виктор", "Глеб", "Демьян",
+    "Евграф", "Иван", "Климент", "Никодим", "Остап", "Поликарп", "Тимофей", "Ян"
+};
+
+static const char* const kFemaleNames[] = {
+    "Алсу", "Анна", "Василиса", "Вера", "Виолетта", "Галина", "Дарья", "Елена",
+    "Ирина", "Мария", "Надежда", "Ольга", "Полина", "Светлана", "Татьяна", "Юлия"
+};
+
+static const char* const kMalePatronymics[] = {
+    "Архипович", "Глебович", "Демьянович", "Евграфович", "Иванович", "Климович", "Никодимович",
+    "Остапович", "Петрович", "Тимофеевич", "Янович"
+};
+
+static const char* const kFemalePatronymics[] = {
+    "Архиповна", "Глебовна", "Демьяновна", "Евграфовна", "Ивановна", "Климовна", "Никодимовна",
+    "Остаповна", "Петровна", "Тимофеевна", "Яновна"
+};
+
+static const char* const kPublishers[] = {
+    "Молодая гвардия", "Жаков и сыновья", "Патриков Ltd", "Феофанов and Co", "Зосимов Ltd",
+    "Архипов Ltd", "Батыров Ltd", "Герасимо and Co", "Феофанов-Editio", "Жаков Ltd"
+};
+
+static const double kPublisherWeights[] = {
+    30, 18, 12, 10, 8, 7, 5, 4, 3, 3
+};
+
+static const char kInitials[] = "АБВГДЕЖЗИКЛМНОПРСТУФЭЮЯ";
+
+template <typename T, size_t N>
+size_t countOf(T (&)[N]) {
+    return N;
+}
+
+struct GeneratorPools {
+    std::vector<std::string> surnames;
+    std::vector<bool> female;
+    std::vector<double> surnameCdf;
+    std::vector<std::string> maleNames;
+    std::vector<std::string> femaleNames;
+    std::vector<std::string> malePatronymics;
+    std::vector<std::string> femalePatronymics;
+    std::vector<std::string> publishers;
+    std::vector<std::string> initials;
+    std::discrete_distribution<int> publisherDist;
+};
+
+void buildPools(GeneratorPools& pools, double skew) {
+    std::vector<std::pair<std::string, bool>> surnames;
+    for (size_t i = 0; i < countOf(kSurnameStems); ++i) {
+        surnames.push_back({utf8ToCP866(kSurnameStems[i]), false});
+        surnames.push_back({utf8ToCP866(std::string(kSurnameStems[i]) + "а"), true});
+    }
+    std::sort(surnames.begin(), surnames.end(), [](const auto& a, const auto& b) {
+        return std::lexicographical_compare(
+            a.first.begin(), a.first.end(), b.first.begin(), b.first.end(),
+            [](char x, char y) { return (unsigned char)x < (unsigned char)y; });
+    });
+    for (const auto& s : surnames) {
+        pools.surnames.push_back(s.first);
+        pools.female.push_back(s.second);
+    }
+
+    std::vector<size_t> rankOrder(pools.surnames.size());
+    for (size_t i = 0; i < rankOrder.size(); ++i) rankOrder[i] = i;
+    std::shuffle(rankOrder.begin(), rankOrder.end(), std::mt19937(7));
+
+    std::vector<double> weights(pools.surnames.size());
+    for (size_t rank = 0; rank < rankOrder.size(); ++rank) {
+        weights[rankOrder[rank]] = 1.0 / std::pow(static_cast<double>(rank + 1), skew);
+    }
+    double total = 0.0;
+    for (double w : weights) {
+        total += w;
+        pools.surnameCdf.push_back(total);
+    }
+    for (double& c : pools.surnameCdf) c /= total;
+
+    for (size_t i = 0; i < countOf(kMaleNames); ++i) pools.maleNames.push_back(utf8ToCP866(kMaleNames[i]));
+    for (size_t i = 0; i < countOf(kFemaleNames); ++i) pools.femaleNames.push_back(utf8ToCP866(kFemaleNames[i]));
+    for (size_t i = 0; i < countOf(kMalePatronymics); ++i) pools.malePatronymics.push_back(utf8ToCP866(kMalePatronymics[i]));
+    for (size_t i = 0; i < countOf(kFemalePatronymics); ++i) pools.femalePatronymics.push_back(utf8ToCP866(kFemalePatronymics[i]));
+    for (size_t i = 0; i < countOf(kPublishers); ++i) pools.publishers.push_back(utf8ToCP866(kPublishers[i]));
+
+    std::string initials = utf8ToCP866(kInitials);
+    for (char c : initials) pools.initials.push_back(std::string(1, c));
+
+    pools.publisherDist = std::discrete_distribution<int>(
+        kPublisherWeights, kPublisherWeights + countOf(kPublisherWeights));
+}
+
+int sampleSurname(const GeneratorPools& pools, std::mt19937& gen) {
+    std::uniform_real_distribution<double> dis(0.0, 1.0);
+    double u = dis(gen);
+    auto it = std::lower_bound(pools.surnameCdf.begin(), pools.surnameCdf.end(), u);
+    if (it == pools.surnameCdf.end()) --it;
+    return static_cast<int>(it - pools.surnameCdf.begin());
+}
+
+void fillField(char* field, size_t size, const std::string& value) {
+    memset(field, ' ', size);
+    memcpy(field, value.data(), std::min(size, value.size()));
+}
+
+void makeRecord(GeneratorPools& pools, std::mt19937& gen, int surname, Record& rec) {
+    auto pick = [&gen](const std::vector<std::string>& pool) -> const std::string& {
+        std::uniform_int_distribution<size_t> dis(0, pool.size() - 1);
+        return pool[dis(gen)];
+    };
+    const std::string space = " ";
+
+    bool female = pools.female[surname];
+    std::string name = pick(female ? pools.femaleNames : pools.maleNames);
+    std::string patronymic = pick(female ? pools.femalePatronymics : pools.malePatronymics);
+    const std::string& surnameText = pools.surnames[surname];
+    size_t room = sizeof(rec.title) - surnameText.size() - 2;
+    if (patronymic.size() + 1 > room) patronymic.resize(room - 1);
+    if (name.size() + patronymic.size() > room) name.resize(room - patronymic.size());
+    std::string title = name + space + patronymic + space + surnameText;
+    fillField(rec.title, sizeof(rec.title), title);
+
+    std::string author = pools.surnames[sampleSurname(pools, gen)];
+    if (author.size() > 8) author.resize(8);
+    author += space + pick(pools.initials) + space + pick(pools.initials);
+    fillField(rec.author, sizeof(rec.author), author);
+
+    fillField(rec.publisher, sizeof(rec.publisher) - 1, pools.publishers[pools.publisherDist(gen)]);
+    rec.publisher[sizeof(rec.publisher) - 1] = '\0';
+
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    rec.year = static_cast<short>(1898 + std::floor(100.0 * std::sqrt(unit(gen))));
+    if (rec.year > 1997) rec.year = 1997;
+
+    std::normal_distribution<double> pagesDist(380.0, 160.0);
+    double pages = pagesDist(gen);
+    rec.pages = static_cast<short>(std::min(899.0, std::max(100.0, std::round(pages))));
+}
+
+std::vector<int> generateSurnameSequence(const GeneratorOptions& opts, const GeneratorPools& pools, std::mt19937& gen) {
+    std::vector<int> sequence(opts.count);
+    if (opts.order == ORDER_EQUAL_SURNAMES) {
+        std::fill(sequence.begin(), sequence.end(), sampleSurname(pools, gen));
+        return sequence;
+    }
+
+    for (int& s : sequence) s = sampleSurname(pools, gen);
+
+    if (opts.order == ORDER_PRESORTED || opts.order == ORDER_NEARLY_SORTED) {
+        long long tail = 0;
+        if (opts.order == ORDER_NEARLY_SORTED) {
+            tail = static_cast<long long>(opts.count * std::min(1.0, std::max(0.0, opts.unsortedTail)));
+        }
+        std::sort(sequence.begin(), sequence.end() - tail);
+    } else if (opts.order == ORDER_REVERSED) {
+        std::sort(sequence.begin(), sequence.end(), [](int a, int b) { return a > b; });
+    }
+    return sequence;
+}
+
+bool parseGeneratorOrder(const std::string& name, GeneratorOrder& order) {
+    if (name == "random") order = ORDER_RANDOM;
+    else if (name == "presorted") order = ORDER_PRESORTED;
+    else if (name == "reversed") order = ORDER_REVERSED;
+    else if (name == "nearly") order = ORDER_NEARLY_SORTED;
+    else if (name == "equal") order = ORDER_EQUAL_SURNAMES;
+    else return false;
+    return true;
+}
+
+std::vector<Record> generateRecords(const GeneratorOptions& opts) {
+    GeneratorPools pools;
+    buildPools(pools, opts.surnameSkew);
+    std::mt19937 gen(opts.seed);
+
+    std::vector<int> sequence = generateSurnameSequence(opts, pools, gen);
+    std::vector<Record> db(sequence.size());
+    for (size_t i = 0; i < sequence.size(); ++i) {
+        makeRecord(pools, gen, sequence[i], db[i]);
+    }
+    return db;
+}
+
+bool writeGeneratedDatabase(const std::string& filename, const GeneratorOptions& opts) {
+    std::ofstream out(filename, std::ios::binary);
+    if (!out) return false;
+
+    GeneratorPools pools;
+    buildPools(pools, opts.surnameSkew);
+    std::mt19937 gen(opts.seed);
+
+    std::vector<int> sequence = generateSurnameSequence(opts, pools, gen);
+    const size_t chunk = 4096;
+    std::vector<Record> buffer(chunk);
+    for (size_t i = 0; i < sequence.size(); i += chunk) {
+        size_t n = std::min(chunk, sequence.size() - i);
+        for (size_t j = 0; j < n; ++j) {
+            makeRecord(pools, gen, sequence[i + j], buffer[j]);
+        }
+        out.write(reinterpret_cast<const char*>(buffer.data()), n * sizeof(Record));
+    }
+    return static_cast<bool>(out);
+}
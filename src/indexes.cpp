@@ -0,0 +1,134 @@
+#include "indexes.h"
+#include "transcode.h"
+#include "instrument.h"
+#include <algorithm>
+#include <cstring>
+
+int compareFieldBytes(const char* a, size_t alen, const char* b, size_t blen) {
+    size_t len = std::min(alen, blen);
+    for (size_t i = 0; i < len; ++i) {
+        unsigned char ca = static_cast<unsigned char>(a[i]);
+        unsigned char cb = static_cast<unsigned char>(b[i]);
+        if (ca != cb) return ca < cb ? -1 : 1;
+    }
+    if (alen == blen) return 0;
+    return alen < blen ? -1 : 1;
+}
+
+bool isNumericField(RecordField field) {
+    return field == FIELD_YEAR || field == FIELD_PAGES;
+}
+
+int compareRecordsByField(const Record& a, const Record& b, RecordField field) {
+    if (isNumericField(field)) {
+        return recordFieldNumber(a, field) - recordFieldNumber(b, field);
+    }
+    size_t alen, blen;
+    const char* pa = recordFieldBytes(a, field, alen);
+    const char* pb = recordFieldBytes(b, field, blen);
+    return compareFieldBytes(pa, alen, pb, blen);
+}
+
+bool parseRecordField(const std::string& name, RecordField& field) {
+    if (name == "author") field = FIELD_AUTHOR;
+    else if (name == "title") field = FIELD_TITLE;
+    else if (name == "publisher") field = FIELD_PUBLISHER;
+    else if (name == "year") field = FIELD_YEAR;
+    else if (name == "pages") field = FIELD_PAGES;
+    else return false;
+    return true;
+}
+
+void initSecondaryIndexes(SecondaryIndexes& indexes, const std::vector<Record>& db) {
+    indexes.db = &db;
+    for (int field = 0; field < SECONDARY_INDEX_COUNT; ++field) {
+        indexes.ready[field] = false;
+    }
+}
+
+const std::vector<Record*>& secondaryIndex(SecondaryIndexes& indexes, RecordField field) {
+    std::call_once(indexes.built[field], [&indexes, field] {
+        INSTR_TIMER("index.build");
+        std::vector<Record*>& index = indexes.byField[field];
+        index.reserve(indexes.db->size());
+        for (const Record& rec : *indexes.db) {
+            index.push_back(const_cast<Record*>(&rec));
+        }
+        std::stable_sort(index.begin(), index.end(), [field](const Record* a, const Record* b) {
+            return compareRecordsByField(*a, *b, field) < 0;
+        });
+        indexes.ready[field] = true;
+    });
+    return indexes.byField[field];
+}
+
+void buildAllSecondaryIndexes(SecondaryIndexes& indexes) {
+    for (int field = 0; field < SECONDARY_INDEX_COUNT; ++field) {
+        secondaryIndex(indexes, static_cast<RecordField>(field));
+    }
+}
+
+std::string textKey(const std::string& utf8) {
+    std::string key = utf8ToCP866(utf8);
+    size_t end = key.find_last_not_of(' ');
+    key.resize(end == std::string::npos ? 0 : end + 1);
+    return key;
+}
+
+std::vector<Record*> lookupEqual(SecondaryIndexes& indexes, RecordField field, const std::string& value) {
+    INSTR_TIMER("index.lookup");
+    if (isNumericField(field)) {
+        int number = std::atoi(value.c_str());
+        return lookupRange(indexes, field, number, number);
+    }
+
+    const std::vector<Record*>& index = secondaryIndex(indexes, field);
+    std::string key = textKey(value);
+    auto first = std::lower_bound(index.begin(), index.end(), key, [field](const Record* rec, const std::string& k) {
+        size_t len;
+        const char* p = recordFieldBytes(*rec, field, len);
+        return compareFieldBytes(p, len, k.data(), k.size()) < 0;
+    });
+    auto last = std::upper_bound(first, index.end(), key, [field](const std::string& k, const Record* rec) {
+        size_t len;
+        const char* p = recordFieldBytes(*rec, field, len);
+        return compareFieldBytes(k.data(), k.size(), p, len) < 0;
+    });
+    return std::vector<Record*>(first, last);
+}
+
+std::vector<Record*> lookupPrefix(SecondaryIndexes& indexes, RecordField field, const std::string& prefix) {
+    INSTR_TIMER("index.lookup");
+    if (isNumericField(field)) return lookupEqual(indexes, field, prefix);
+
+    const std::vector<Record*>& index = secondaryIndex(indexes, field);
+    std::string key = utf8ToCP866(prefix);
+    auto it = std::lower_bound(index.begin(), index.end(), key, [field](const Record* rec, const std::string& k) {
+        size_t len;
+        const char* p = recordFieldBytes(*rec, field, len);
+        return compareFieldBytes(p, len, k.data(), k.size()) < 0;
+    });
+
+    std::vector<Record*> result;
+    for (; it != index.end(); ++it) {
+        size_t len;
+        const char* p = recordFieldBytes(**it, field, len);
+        if (len < key.size() || memcmp(p, key.data(), key.size()) != 0) break;
+        result.push_back(*it);
+    }
+    return result;
+}
+
+std::vector<Record*> lookupRange(SecondaryIndexes& indexes, RecordField field, int low, int high) {
+    INSTR_TIMER("index.lookup");
+    if (!isNumericField(field) || low > high) return std::vector<Record*>();
+
+    const std::vector<Record*>& index = secondaryIndex(indexes, field);
+    auto first = std::lower_bound(index.begin(), index.end(), low, [field](const Record* rec, int v) {
+        return recordFieldNumber(*rec, field) < v;
+    });
+    auto last = std::upper_bound(first, index.end(), high, [field](int v, const Record* rec) {
+        return v < recordFieldNumber(*rec, field);
+    });
+    return std::vector<Record*>(first, last);
+}
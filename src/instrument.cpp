@@ -0,0 +1,76 @@
+#include "instrument.h"
+#include <iomanip>
+
+#ifdef COURSEWORK_INSTRUMENT
+
+#include <deque>
+#include <mutex>
+#include <cstring>
+
+static std::deque<InstrumentCounter>& instrumentRegistry() {
+    static std::deque<InstrumentCounter> registry;
+    return registry;
+}
+
+static std::mutex instrumentMutex;
+
+InstrumentCounter& registerInstrumentCounter(const char* name, bool isTimer) {
+    std::lock_guard<std::mutex> lock(instrumentMutex);
+    for (InstrumentCounter& c : instrumentRegistry()) {
+        if (strcmp(c.name, name) == 0 && c.isTimer == isTimer) return c;
+    }
+    InstrumentCounter& c = instrumentRegistry().emplace_back();
+    c.name = name;
+    c.isTimer = isTimer;
+    c.count = 0;
+    c.totalNs = 0;
+    c.maxNs = 0;
+    return c;
+}
+
+bool instrumentationEnabled() {
+    return true;
+}
+
+void writeInstrumentReport(std::ostream& out) {
+    std::lock_guard<std::mutex> lock(instrumentMutex);
+    out << std::left << std::setw(28) << "name" << std::setw(7) << "kind"
+        << std::right << std::setw(14) << "count" << std::setw(14) << "total_ms"
+        << std::setw(12) << "avg_us" << std::setw(12) << "max_us" << "\n";
+    for (const InstrumentCounter& c : instrumentRegistry()) {
+        long long count = c.count.load();
+        out << std::left << std::setw(28) << c.name << std::setw(7) << (c.isTimer ? "timer" : "count")
+            << std::right << std::setw(14) << count;
+        if (c.isTimer) {
+            double totalMs = c.totalNs.load() / 1e6;
+            double avgUs = count > 0 ? c.totalNs.load() / 1e3 / count : 0.0;
+            out << std::fixed << std::setprecision(3) << std::setw(14) << totalMs
+                << std::setw(12) << avgUs << std::setw(12) << c.maxNs.load() / 1e3;
+        }
+        out << "\n";
+    }
+}
+
+void resetInstrumentCounters() {
+    std::lock_guard<std::mutex> lock(instrumentMutex);
+    for (InstrumentCounter& c : instrumentRegistry()) {
+        c.count = 0;
+        c.totalNs = 0;
+        c.maxNs = 0;
+    }
+}
+
+#else
+
+bool instrumentationEnabled() {
+    return false;
+}
+
+void writeInstrumentReport(std::ostream& out) {
+    out << "Инструментирование отключено (соберите с -DCOURSEWORK_INSTRUMENT=ON)\n";
+}
+
+void resetInstrumentCounters() {
+}
+
+#endif
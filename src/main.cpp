@@ -4,34 +4,194 @@
 #include "search.h"
 #include "queue.h"
 #include "tree.h"
+#include "batch.h"
+#include "indexes.h"
+#include "textcache.h"
+#include "instrument.h"
+#include "server.h"
+#include "append.h"
+#include "shards.h"
+#include <atomic>
+#include <future>
+#include <thread>
 
-int main() {
-    std::vector<Record> db = loadDatabase("testBase1.dat");
-    if (db.empty()) {
-        std::cout << "Ошибка: не удалось загрузить базу данных 'testBase1.dat'!" << std::endl;
+struct ProgramOptions {
+    std::vector<std::string> dbFiles;
+    bool batch = false;
+    std::string batchFile;
+    BatchFormat format = BATCH_TSV;
+    bool stats = false;
+    std::string appendFile;
+    std::string serveSocket;
+    int threads = 0;
+    SortMethod sortMethod = SORT_METHOD_HOARE;
+};
+
+bool parseProgramArgs(int argc, char** argv, ProgramOptions& opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--db" && i + 1 < argc) {
+            opts.dbFiles.push_back(argv[++i]);
+        } else if (arg == "--batch") {
+            opts.batch = true;
+            if (i + 1 < argc && std::string(argv[i + 1]).rfind("--", 0) != 0) {
+                opts.batchFile = argv[++i];
+            }
+        } else if (arg == "--append" && i + 1 < argc) {
+            opts.appendFile = argv[++i];
+        } else if (arg == "--serve" && i + 1 < argc) {
+            opts.serveSocket = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            opts.threads = std::atoi(argv[++i]);
+        } else if (arg == "--sort" && i + 1 < argc) {
+            if (!parseSortMethod(argv[++i], opts.sortMethod)) return false;
+        } else if (arg == "--stats") {
+            opts.stats = true;
+        } else if (arg == "--format" && i + 1 < argc) {
+            if (!parseBatchFormat(argv[++i], opts.format)) return false;
+        } else {
+            return false;
+        }
+    }
+    if (opts.dbFiles.empty()) opts.dbFiles.push_back("testBase1.dat");
+    return true;
+}
+
+int runBatchMode(const ProgramOptions& opts, const std::vector<Record>& db, const std::vector<Record*>& indices,
+                 SecondaryIndexes& indexes, ColumnStore& columns, TextSearchIndex& textSearch) {
+    std::ios::sync_with_stdio(false);
+
+    BatchShared shared;
+    initBatchShared(shared, 1);
+    BatchContext ctx;
+    initBatchContext(ctx, db, indices, indexes, columns, textSearch, shared, opts.dbFiles, opts.format);
+    ctx.threads = opts.threads;
+
+    if (opts.batchFile.empty() || opts.batchFile == "-") {
+        runBatch(ctx, std::cin, std::cout);
+    } else {
+        std::ifstream in(opts.batchFile);
+        if (!in) {
+            std::cerr << "Ошибка: не удалось открыть файл запросов '" << opts.batchFile << "'!" << std::endl;
+            clearBatchContext(ctx);
+            clearBatchShared(shared);
+            return 1;
+        }
+        runBatch(ctx, in, std::cout);
+    }
+
+    if (opts.stats) writeBatchSharedStats(shared, std::cerr);
+    clearBatchContext(ctx);
+    clearBatchShared(shared);
+    return 0;
+}
+
+void prepareSortedIndexes(std::vector<Record*>& indices, bool sort, const std::vector<DatabaseShard>& shards,
+                          SortMethod method, std::promise<void>& sorted,
+                          SecondaryIndexes& indexes, TextSearchIndex& textSearch, const std::atomic<bool>& stop) {
+    if (sort) sortShardedIndex(indices, shards, method);
+    sorted.set_value();
+    for (int field = 0; field < SECONDARY_INDEX_COUNT && !stop; ++field) {
+        secondaryIndex(indexes, static_cast<RecordField>(field));
+    }
+    if (!stop) buildTextSearchIndex(textSearch);
+}
+
+int main(int argc, char** argv) {
+    ProgramOptions opts;
+    if (!parseProgramArgs(argc, argv, opts)) {
+        std::cerr << "Использование: coursework [--db FILE]... [--append NEW.dat] [--batch [QUERIES|-]] [--format tsv|json]\n"
+                     "                  [--serve SOCKET] [--threads N] [--sort hoare|adaptive] [--stats]" << std::endl;
+        return 2;
+    }
+
+    std::vector<Record> db;
+    std::vector<DatabaseShard> shards;
+    if (!loadShardedDatabase(opts.dbFiles, db, shards) || db.empty()) {
+        std::string names;
+        for (const std::string& file : opts.dbFiles) names += (names.empty() ? "" : "', '") + file;
+        std::cerr << "Ошибка: не удалось загрузить базу данных '" << names << "'!" << std::endl;
         return 1;
     }
 
+    attachRecordTextCache(db);
+
     std::vector<Record*> indices;
     for (auto& rec : db) {
         indices.push_back(&rec);
     }
 
-    quickSortHoare(indices, 0, indices.size() - 1);
+    bool sortInBackground = !opts.batch && opts.serveSocket.empty() && opts.appendFile.empty();
+    if (!sortInBackground) {
+        sortShardedIndex(indices, shards, opts.sortMethod);
+    }
+
+    SecondaryIndexes indexes;
+    initSecondaryIndexes(indexes, db);
+    ColumnStore columns;
+    initColumnStore(columns, db);
+    TextSearchIndex textSearch;
+    initTextSearchIndex(textSearch, db, indices);
+
+    if (!opts.appendFile.empty()) {
+        std::vector<Record> batch = loadDatabase(opts.appendFile);
+        if (batch.empty()) {
+            std::cerr << "Ошибка: нет записей для добавления в '" << opts.appendFile << "'!" << std::endl;
+            return 1;
+        }
+        if (!appendRecords(opts.dbFiles.back(), db, indices, indexes, nullptr, batch)) {
+            std::cerr << "Ошибка: не удалось дописать записи в '" << opts.dbFiles.back() << "'!" << std::endl;
+            return 1;
+        }
+        std::cerr << "Добавлено записей: " << batch.size() << std::endl;
+        if (!opts.batch && opts.serveSocket.empty()) {
+            if (opts.stats) writeInstrumentReport(std::cerr);
+            return 0;
+        }
+    }
+
+    if (!opts.serveSocket.empty()) {
+        ServerOptions serverOpts{opts.serveSocket, opts.threads, opts.format, opts.dbFiles};
+        BatchShared shared;
+        initBatchShared(shared, BATCH_PREFIX_SHARDS);
+        ServerSnapshot snapshot{&db, &indices, &indexes, &columns, &textSearch, &shared};
+        int status = runServer(serverOpts, snapshot);
+        if (opts.stats) {
+            writeInstrumentReport(std::cerr);
+            writeBatchSharedStats(shared, std::cerr);
+        }
+        clearBatchShared(shared);
+        return status;
+    }
+
+    if (opts.batch) {
+        int status = runBatchMode(opts, db, indices, indexes, columns, textSearch);
+        if (opts.stats) writeInstrumentReport(std::cerr);
+        return status;
+    }
+
+    PrefixCache prefixCache;
+    initPrefixCache(prefixCache, PREFIX_CACHE_CAPACITY);
+
+    std::promise<void> sorted;
+    std::shared_future<void> sortedReady = sorted.get_future().share();
+    std::atomic<bool> stopBackground(false);
+    std::thread indexBuilder(prepareSortedIndexes, std::ref(indices), sortInBackground, std::cref(shards),
+                             opts.sortMethod, std::ref(sorted),
+                             std::ref(indexes), std::ref(textSearch), std::cref(stopBackground));
+    std::thread textWarmer(warmRecordTextCache, std::cref(db), std::cref(stopBackground));
 
-    Queue* currentQueue = new Queue;
-    initQueue(*currentQueue);
-    
-    OptimalSearchTree* optimalTree = nullptr;
+    displayMainMenu(db, indices, sortedReady, indexes, textSearch, columns, prefixCache, opts.dbFiles);
 
-    displayMainMenu(db, indices, currentQueue, optimalTree);
+    stopBackground = true;
+    textWarmer.join();
+    indexBuilder.join();
 
-    clearQueue(*currentQueue);
-    delete currentQueue;
-    
-    if (optimalTree != nullptr) {
-        clearOptimalTree(optimalTree);
+    if (opts.stats) {
+        writeInstrumentReport(std::cerr);
+        writePrefixCacheStats(prefixCache, std::cerr);
     }
+    clearPrefixCache(prefixCache);
 
     return 0;
-}
\ No newline at end of file
+}
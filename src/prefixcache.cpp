@@ -0,0 +1,89 @@
+#include "prefixcache.h"
+#include "search.h"
+#include "instrument.h"
+
+void initPrefixCache(PrefixCache& cache, size_t capacity) {
+    cache.capacity = capacity > 0 ? capacity : 1;
+    cache.entries.clear();
+    cache.lookup.clear();
+    cache.source = nullptr;
+    cache.sourceSize = 0;
+    cache.hits = 0;
+    cache.misses = 0;
+    cache.evictions = 0;
+    cache.treeHits = 0;
+    cache.treeBuilds = 0;
+}
+
+void releaseEntry(PrefixCacheEntry& entry) {
+    clearQueue(entry.queue);
+    if (entry.tree != nullptr) {
+        clearOptimalTree(entry.tree);
+        entry.tree = nullptr;
+    }
+}
+
+void invalidatePrefixCache(PrefixCache& cache) {
+    for (PrefixCacheEntry& entry : cache.entries) {
+        releaseEntry(entry);
+    }
+    cache.entries.clear();
+    cache.lookup.clear();
+    cache.source = nullptr;
+    cache.sourceSize = 0;
+}
+
+void clearPrefixCache(PrefixCache& cache) {
+    invalidatePrefixCache(cache);
+    initPrefixCache(cache, cache.capacity);
+}
+
+PrefixCacheEntry& cachedPrefixSearch(PrefixCache& cache, const std::vector<Record*>& indices, const std::string& prefix) {
+    if (cache.source != &indices || cache.sourceSize != indices.size()) {
+        invalidatePrefixCache(cache);
+        cache.source = &indices;
+        cache.sourceSize = indices.size();
+    }
+
+    std::string key = normalizeSearchPrefix(prefix);
+    auto found = cache.lookup.find(key);
+    if (found != cache.lookup.end()) {
+        INSTR_COUNT("prefixcache.hit");
+        cache.hits++;
+        cache.entries.splice(cache.entries.begin(), cache.entries, found->second);
+        return cache.entries.front();
+    }
+
+    INSTR_COUNT("prefixcache.miss");
+    cache.misses++;
+    if (cache.entries.size() >= cache.capacity) {
+        PrefixCacheEntry& oldest = cache.entries.back();
+        cache.lookup.erase(oldest.prefix);
+        releaseEntry(oldest);
+        cache.entries.pop_back();
+        cache.evictions++;
+    }
+
+    cache.entries.push_front(PrefixCacheEntry{key, binarySearchWithIndexing(indices, prefix), nullptr});
+    cache.lookup[key] = cache.entries.begin();
+    return cache.entries.front();
+}
+
+OptimalSearchTree* cachedPrefixTree(PrefixCache& cache, PrefixCacheEntry& entry) {
+    if (entry.tree != nullptr) {
+        cache.treeHits++;
+        return entry.tree;
+    }
+    cache.treeBuilds++;
+    entry.tree = buildOptimalSearchTreeA1(entry.queue);
+    return entry.tree;
+}
+
+void writePrefixCacheStats(const PrefixCache& cache, std::ostream& out) {
+    long long total = cache.hits + cache.misses;
+    out << "Кэш префиксов: " << cache.entries.size() << "/" << cache.capacity
+        << ", попаданий " << cache.hits << " из " << total
+        << ", вытеснений " << cache.evictions
+        << ", деревьев построено " << cache.treeBuilds
+        << ", взято из кэша " << cache.treeHits << std::endl;
+}
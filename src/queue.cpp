@@ -1,4 +1,5 @@
 #include "queue.h"
+#include "instrument.h"
 #include <iostream>
 
 void initQueue(Queue& q) {
@@ -7,6 +8,7 @@ void initQueue(Queue& q) {
 }
 
 void enqueue(Queue& q, Record* rec) {
+    INSTR_COUNT("queue.node_alloc");
     QueueNode* newNode = new QueueNode;
     newNode->data = rec;
     newNode->next = nullptr;
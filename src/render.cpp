@@ -0,0 +1,101 @@
+#include "render.h"
+#include "textcache.h"
+#include <unistd.h>
+#include <cerrno>
+
+static const char* const kClearSequence = "\x1b[H\x1b[2J\x1b[3J";
+
+size_t displayWidth(const std::string& utf8) {
+    size_t width = 0;
+    for (unsigned char c : utf8) {
+        if ((c & 0xC0) != 0x80) width++;
+    }
+    return width;
+}
+
+void appendPadded(std::string& out, const std::string& text, size_t width) {
+    out += text;
+    size_t w = displayWidth(text);
+    if (w < width) out.append(width - w, ' ');
+}
+
+void appendPaddedLeft(std::string& out, const std::string& text, size_t width) {
+    size_t w = displayWidth(text);
+    if (w < width) out.append(width - w, ' ');
+    out += text;
+}
+
+void beginScreen(std::string& screen) {
+    screen.assign(kClearSequence);
+}
+
+void appendBorder(std::string& screen, BorderKind kind) {
+    const char* left = kind == BORDER_TOP ? "╔" : (kind == BORDER_MIDDLE ? "╠" : "╚");
+    const char* right = kind == BORDER_TOP ? "╗" : (kind == BORDER_MIDDLE ? "╣" : "╝");
+    screen += left;
+    for (int i = 0; i < SCREEN_TEXT_WIDTH + 1; ++i) screen += "═";
+    screen += right;
+    screen += '\n';
+}
+
+void appendBoxLine(std::string& screen, const std::string& text) {
+    screen += "║ ";
+    appendPadded(screen, text, SCREEN_TEXT_WIDTH);
+    screen += "║\n";
+}
+
+void appendCenteredBoxLine(std::string& screen, const std::string& text) {
+    size_t w = displayWidth(text);
+    size_t left = w < SCREEN_TEXT_WIDTH ? (SCREEN_TEXT_WIDTH - w) / 2 : 0;
+    appendBoxLine(screen, std::string(left, ' ') + text);
+}
+
+void appendRecordTableHeader(std::string& screen, const std::string& title) {
+    appendBorder(screen, BORDER_TOP);
+    appendBoxLine(screen, title);
+    appendBorder(screen, BORDER_MIDDLE);
+    appendBoxLine(screen, "Автор        Заглавие                         Издательство     Год  Стр");
+    appendBorder(screen, BORDER_MIDDLE);
+}
+
+void appendRecordRow(std::string& screen, const Record* rec) {
+    RecordTextRef text = cachedRecordText(rec);
+    std::string row;
+    row.reserve(160);
+    appendPadded(row, text->author, 12);
+    row += ' ';
+    appendPadded(row, text->title, 32);
+    row += ' ';
+    appendPadded(row, text->publisher, 16);
+    row += ' ';
+    appendPadded(row, std::to_string(rec->year), 4);
+    row += ' ';
+    appendPadded(row, std::to_string(rec->pages), 4);
+    appendBoxLine(screen, row);
+}
+
+void appendEmptyRows(std::string& screen, int count) {
+    for (int i = 0; i < count; ++i) appendBoxLine(screen, "");
+}
+
+void flushScreen(std::string& screen) {
+    std::cout.flush();
+    const char* data = screen.data();
+    size_t left = screen.size();
+    while (left > 0) {
+        ssize_t written = write(STDOUT_FILENO, data, left);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        data += written;
+        left -= written;
+    }
+    screen.clear();
+}
+
+void clearScreen() {
+    std::string screen;
+    beginScreen(screen);
+    flushScreen(screen);
+}
@@ -1,14 +1,22 @@
 #include "search.h"
+#include "instrument.h"
 #include <iostream>
 #include <cstring>
 #include <iomanip>
 
+size_t utf8PrefixLength(const std::string& s, size_t letters) {
+    size_t pos = 0;
+    while (pos < s.size() && letters > 0) {
+        pos++;
+        while (pos < s.size() && (static_cast<unsigned char>(s[pos]) & 0xC0) == 0x80) pos++;
+        letters--;
+    }
+    return pos;
+}
+
 std::string getSurnamePrefix(const Record& rec) {
     std::string surname = extractSurname(rec);
-    if (surname.length() >= 3) {
-        return surname.substr(0, 3);
-    }
-    return surname;
+    return surname.substr(0, utf8PrefixLength(surname, 3));
 }
 
 unsigned char toUpperCP866(unsigned char c) {
@@ -18,13 +26,37 @@ unsigned char toUpperCP866(unsigned char c) {
     return c;
 }
 
+std::string normalizeSearchPrefix(const std::string& text) {
+    std::string result = text.substr(0, utf8PrefixLength(text, 3));
+    for (size_t i = 0; i < result.size(); i++) {
+        unsigned char c = result[i];
+        if (c >= 'a' && c <= 'z') {
+            result[i] = c - 32;
+        } else if (c == 0xD0 && i + 1 < result.size()) {
+            unsigned char next = result[i + 1];
+            if (next >= 0xB0 && next <= 0xBF) result[i + 1] = next - 0x20;
+            i++;
+        } else if (c == 0xD1 && i + 1 < result.size()) {
+            unsigned char next = result[i + 1];
+            if (next >= 0x80 && next <= 0x8F) {
+                result[i] = 0xD0;
+                result[i + 1] = next + 0x20;
+            } else if (next == 0x91) {
+                result[i] = 0xD0;
+                result[i + 1] = 0x81;
+            }
+            i++;
+        }
+    }
+    return result;
+}
+
 bool compareLess(const std::string& a, const std::string& b) {
-    for (size_t i = 0; i < 3; i++) {
+    for (size_t i = 0; i < b.length(); i++) {
         if (i >= a.length()) return true;
-        if (i >= b.length()) return false;
         
-        unsigned char ca = toUpperCP866((unsigned char)a[i]);
-        unsigned char cb = toUpperCP866((unsigned char)b[i]);
+        unsigned char ca = (unsigned char)a[i];
+        unsigned char cb = (unsigned char)b[i];
         
         if (ca < cb) return true;
         if (ca > cb) return false;
@@ -33,18 +65,15 @@ bool compareLess(const std::string& a, const std::string& b) {
 }
 
 bool exactMatch(const std::string& a, const std::string& b) {
-    for (size_t i = 0; i < 3; i++) {
-        if (i >= a.length() || i >= b.length()) return false;
-        
-        unsigned char ca = toUpperCP866((unsigned char)a[i]);
-        unsigned char cb = toUpperCP866((unsigned char)b[i]);
-        
-        if (ca != cb) return false;
+    if (a.length() < b.length()) return false;
+    for (size_t i = 0; i < b.length(); i++) {
+        if (a[i] != b[i]) return false;
     }
     return true;
 }
 
 Queue binarySearchWithIndexing(const std::vector<Record*>& indices, const std::string& prefix) {
+    INSTR_TIMER("search.binary");
     Queue resultQueue;
     initQueue(resultQueue);
     
@@ -52,24 +81,16 @@ Queue binarySearchWithIndexing(const std::vector<Record*>& indices, const std::s
         return resultQueue;
     }
     
-    std::string target = prefix;
-    if (target.length() > 3) target = target.substr(0, 3);
-    
-    for (char& c : target) {
-        c = toUpperCP866((unsigned char)c);
-    }
+    std::string target = normalizeSearchPrefix(prefix);
     
     int L = 0;
     int R = indices.size() - 1;
     
     while (L < R) {
         int m = (L + R) / 2;
+        INSTR_COUNT("search.probe");
         
-        std::string current = getSurnamePrefix(*indices[m]);
-        
-        for (char& c : current) {
-            c = toUpperCP866((unsigned char)c);
-        }
+        std::string current = normalizeSearchPrefix(extractSurname(*indices[m]));
         
         if (compareLess(current, target)) {
             L = m + 1;
@@ -79,28 +100,11 @@ Queue binarySearchWithIndexing(const std::vector<Record*>& indices, const std::s
     }
     
     if (L >= 0 && L < (int)indices.size()) {
-        std::string found = getSurnamePrefix(*indices[L]);
-        
-        for (char& c : found) {
-            c = toUpperCP866((unsigned char)c);
-        }
+        std::string found = normalizeSearchPrefix(extractSurname(*indices[L]));
         
         if (exactMatch(found, target)) {
-            int start = L;
-            while (start > 0) {
-                std::string prev = getSurnamePrefix(*indices[start - 1]);
-                for (char& c : prev) c = toUpperCP866((unsigned char)c);
-                
-                if (exactMatch(prev, target)) {
-                    start--;
-                } else {
-                    break;
-                }
-            }
-            
-            for (int i = start; i < (int)indices.size(); i++) {
-                std::string current = getSurnamePrefix(*indices[i]);
-                for (char& c : current) c = toUpperCP866((unsigned char)c);
+            for (int i = L; i < (int)indices.size(); i++) {
+                std::string current = normalizeSearchPrefix(extractSurname(*indices[i]));
                 
                 if (exactMatch(current, target)) {
                     enqueue(resultQueue, indices[i]);
@@ -112,4 +116,4 @@ Queue binarySearchWithIndexing(const std::vector<Record*>& indices, const std::s
     }
     
     return resultQueue;
-}
\ No newline at end of file
+}
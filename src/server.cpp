@@ -0,0 +1,338 @@
+#include "server.h"
+#include "textcache.h"
+#include "instrument.h"
+#include <condition_variable>
+#include <csignal>
+#include <cerrno>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static volatile std::sig_atomic_t serverStopRequested = 0;
+
+void requestServerStop(int) {
+    serverStopRequested = 1;
+}
+
+struct ServerConnection {
+    int fd;
+    std::string buffer;
+    std::string output;
+    long long id;
+    bool eof;
+};
+
+struct ConnectionQueue {
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<ServerConnection*> pending;
+    std::vector<ServerConnection*> idle;
+    int wakeFd;
+    bool closed = false;
+};
+
+bool readSocketLine(int fd, std::string& buffer, std::string& line) {
+    while (true) {
+        size_t pos = buffer.find('\n');
+        if (pos != std::string::npos) {
+            line.assign(buffer, 0, pos);
+            buffer.erase(0, pos + 1);
+            return true;
+        }
+        char chunk[4096];
+        ssize_t n = read(fd, chunk, sizeof(chunk));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            if (buffer.empty()) return false;
+            line.swap(buffer);
+            buffer.clear();
+            return true;
+        }
+        buffer.append(chunk, n);
+    }
+}
+
+bool writeSocketAll(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+bool flushConnection(ServerConnection& conn) {
+    size_t sent = 0;
+    while (sent < conn.output.size()) {
+        ssize_t n = send(conn.fd, conn.output.data() + sent, conn.output.size() - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (n <= 0) return false;
+        sent += n;
+    }
+    conn.output.erase(0, sent);
+    return true;
+}
+
+bool hasPendingQuery(const ServerConnection& conn) {
+    if (conn.output.size() >= SERVER_OUTPUT_PAUSE) return false;
+    return conn.buffer.find('\n') != std::string::npos || (conn.eof && !conn.buffer.empty());
+}
+
+bool serveReadable(BatchContext& ctx, ServerConnection& conn) {
+    char chunk[4096];
+    while (!conn.eof && conn.buffer.size() < SERVER_MAX_INPUT) {
+        ssize_t n = recv(conn.fd, chunk, sizeof(chunk), MSG_DONTWAIT);
+        if (n > 0) {
+            conn.buffer.append(chunk, n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (n < 0) return false;
+        conn.eof = true;
+    }
+
+    size_t lineStart = 0;
+    while (conn.output.size() < SERVER_OUTPUT_PAUSE && lineStart < conn.buffer.size()) {
+        size_t pos = conn.buffer.find('\n', lineStart);
+        if (pos == std::string::npos) {
+            if (!conn.eof) break;
+            pos = conn.buffer.size();
+        }
+        std::string line = conn.buffer.substr(lineStart, pos - lineStart);
+        lineStart = pos + 1;
+
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#') continue;
+        size_t end = line.find_last_not_of(" \t\r");
+        executeBatchQuery(ctx, line.substr(start, end - start + 1), ++conn.id, conn.output);
+        conn.output += '\n';
+    }
+    conn.buffer.erase(0, std::min(lineStart, conn.buffer.size()));
+
+    if (conn.output.size() > SERVER_MAX_OUTPUT ||
+        (conn.buffer.size() >= SERVER_MAX_INPUT && conn.buffer.find('\n') == std::string::npos)) {
+        INSTR_COUNT("server.overflow");
+        return false;
+    }
+    if (!flushConnection(conn)) return false;
+    return !(conn.eof && conn.buffer.empty() && conn.output.empty());
+}
+
+void closeConnection(ServerConnection* conn) {
+    close(conn->fd);
+    delete conn;
+}
+
+void serverWorker(const ServerOptions& opts, const ServerSnapshot& snapshot, ConnectionQueue& queue) {
+    BatchContext ctx;
+    initBatchContext(ctx, *snapshot.db, *snapshot.indices, *snapshot.indexes, *snapshot.columns, *snapshot.textSearch,
+                     *snapshot.shared, opts.dbFiles, opts.format);
+    ctx.fileCommands = false;
+    ctx.threads = 1;
+
+    while (true) {
+        ServerConnection* conn;
+        {
+            std::unique_lock<std::mutex> lock(queue.mutex);
+            queue.ready.wait(lock, [&queue] { return queue.closed || !queue.pending.empty(); });
+            if (queue.closed) break;
+            conn = queue.pending.front();
+            queue.pending.pop_front();
+        }
+
+        INSTR_COUNT("server.dispatch");
+        if (serveReadable(ctx, *conn)) {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.idle.push_back(conn);
+        } else {
+            closeConnection(conn);
+        }
+        char wake = 0;
+        ssize_t ignored = write(queue.wakeFd, &wake, 1);
+        (void)ignored;
+    }
+
+    clearBatchContext(ctx);
+}
+
+bool removeStaleSocket(const std::string& path, const sockaddr_un& addr) {
+    struct stat st;
+    if (lstat(path.c_str(), &st) < 0) return true;
+    if (!S_ISSOCK(st.st_mode)) {
+        std::cerr << "Путь " << path << " занят файлом, который не является сокетом" << std::endl;
+        return false;
+    }
+    int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe < 0) return false;
+    bool live = connect(probe, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0;
+    close(probe);
+    if (live) {
+        std::cerr << "Сокет " << path << " уже обслуживается другим сервером" << std::endl;
+        return false;
+    }
+    if (unlink(path.c_str()) < 0) {
+        std::cerr << "Не удалось удалить старый сокет " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int openServerSocket(const std::string& path) {
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "Слишком длинный путь сокета: " << path << std::endl;
+        return -1;
+    }
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    if (!removeStaleSocket(path, addr)) return -1;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        std::cerr << "Ошибка создания сокета" << std::endl;
+        return -1;
+    }
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(fd, SOMAXCONN) < 0) {
+        std::cerr << "Ошибка привязки сокета " << path << std::endl;
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int runServer(const ServerOptions& opts, const ServerSnapshot& snapshot) {
+    buildAllSecondaryIndexes(*snapshot.indexes);
+    columnStore(*snapshot.columns);
+    buildTextSearchIndex(*snapshot.textSearch);
+    std::atomic<bool> stopWarming(false);
+    warmRecordTextCache(*snapshot.db, stopWarming);
+
+    int listenFd = openServerSocket(opts.socketPath);
+    if (listenFd < 0) return 1;
+
+    serverStopRequested = 0;
+    std::signal(SIGINT, requestServerStop);
+    std::signal(SIGTERM, requestServerStop);
+
+    int wakePipe[2];
+    if (pipe(wakePipe) < 0) {
+        close(listenFd);
+        return 1;
+    }
+    fcntl(wakePipe[1], F_SETFL, O_NONBLOCK);
+
+    int threads = opts.threads > 0 ? opts.threads : std::max(1u, std::thread::hardware_concurrency());
+    ConnectionQueue queue;
+    queue.wakeFd = wakePipe[1];
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back(serverWorker, std::cref(opts), std::cref(snapshot), std::ref(queue));
+    }
+
+    std::cerr << "Сервер слушает " << opts.socketPath << " (" << threads << " потоков, "
+              << snapshot.db->size() << " записей)" << std::endl;
+
+    std::vector<ServerConnection*> waiting;
+    std::vector<ServerConnection*> polled;
+    std::vector<ServerConnection*> dispatch;
+    std::vector<pollfd> pfds;
+    while (!serverStopRequested) {
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            waiting.insert(waiting.end(), queue.idle.begin(), queue.idle.end());
+            queue.idle.clear();
+        }
+
+        polled.clear();
+        dispatch.clear();
+        for (ServerConnection* conn : waiting) {
+            if (hasPendingQuery(*conn)) dispatch.push_back(conn);
+            else polled.push_back(conn);
+        }
+        waiting.clear();
+
+        pfds.assign({pollfd{listenFd, POLLIN, 0}, pollfd{wakePipe[0], POLLIN, 0}});
+        for (ServerConnection* conn : polled) {
+            short events = 0;
+            if (!conn->eof && conn->output.size() < SERVER_OUTPUT_PAUSE) events |= POLLIN;
+            if (!conn->output.empty()) events |= POLLOUT;
+            pfds.push_back(pollfd{conn->fd, events, 0});
+        }
+
+        int ready = poll(pfds.data(), pfds.size(), dispatch.empty() ? 200 : 0);
+        if (ready <= 0 && dispatch.empty()) {
+            waiting.swap(polled);
+            continue;
+        }
+
+        if (pfds[1].revents & POLLIN) {
+            char drain[256];
+            ssize_t ignored = read(wakePipe[0], drain, sizeof(drain));
+            (void)ignored;
+        }
+
+        for (size_t i = 0; i < polled.size(); ++i) {
+            ServerConnection* conn = polled[i];
+            short revents = pfds[i + 2].revents;
+            if (revents == 0) {
+                waiting.push_back(conn);
+                continue;
+            }
+            if ((revents & POLLOUT) && !flushConnection(*conn)) {
+                closeConnection(conn);
+            } else if (revents & (POLLIN | POLLHUP | POLLERR)) {
+                if (conn->eof) closeConnection(conn);
+                else dispatch.push_back(conn);
+            } else if (conn->eof && conn->buffer.empty() && conn->output.empty()) {
+                closeConnection(conn);
+            } else {
+                waiting.push_back(conn);
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.pending.insert(queue.pending.end(), dispatch.begin(), dispatch.end());
+            if (pfds[0].revents & POLLIN) {
+                int clientFd = accept(listenFd, nullptr, nullptr);
+                if (clientFd >= 0) {
+                    INSTR_COUNT("server.connection");
+                    fcntl(clientFd, F_SETFL, O_NONBLOCK);
+                    waiting.push_back(new ServerConnection{clientFd, std::string(), std::string(), 0, false});
+                }
+            }
+        }
+        if (dispatch.size() == 1) queue.ready.notify_one();
+        else if (dispatch.size() > 1) queue.ready.notify_all();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.closed = true;
+    }
+    queue.ready.notify_all();
+    for (std::thread& worker : workers) worker.join();
+
+    waiting.insert(waiting.end(), queue.pending.begin(), queue.pending.end());
+    waiting.insert(waiting.end(), queue.idle.begin(), queue.idle.end());
+    for (ServerConnection* conn : waiting) closeConnection(conn);
+    close(wakePipe[0]);
+    close(wakePipe[1]);
+    close(listenFd);
+    unlink(opts.socketPath.c_str());
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    std::cerr << "Сервер остановлен" << std::endl;
+    return 0;
+}
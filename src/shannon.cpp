@@ -1,4 +1,7 @@
 #include "shannon.h"
+#include "instrument.h"
+#include "render.h"
+#include "transcode.h"
 #include <iostream>
 #include <fstream>
 #include <iomanip>
@@ -7,125 +10,32 @@
 #include <map>
 #include <vector>
 #include <cstring>
-
-#define MAX_SYMBOLS 256
-#define MAX_CODE_LEN 256
-
-typedef struct {
-    unsigned char symbol;
-    int freq;
-    char code[MAX_CODE_LEN];
-    int code_len;
-} SymbolInfo;
+#include <sstream>
 
 std::string cp866ToChar(unsigned char c) {
-    if (c >= 32 && c <= 126) {
-        return std::string(1, static_cast<char>(c));
-    }
-    
-    switch(c) {
-        case 128: return "А";
-        case 129: return "Б";
-        case 130: return "В";
-        case 131: return "Г";
-        case 132: return "Д";
-        case 133: return "Е";
-        case 134: return "Ж";
-        case 135: return "З";
-        case 136: return "И";
-        case 137: return "Й";
-        case 138: return "К";
-        case 139: return "Л";
-        case 140: return "М";
-        case 141: return "Н";
-        case 142: return "О";
-        case 143: return "П";
-        case 144: return "Р";
-        case 145: return "С";
-        case 146: return "Т";
-        case 147: return "У";
-        case 148: return "Ф";
-        case 149: return "Х";
-        case 150: return "Ц";
-        case 151: return "Ч";
-        case 152: return "Ш";
-        case 153: return "Щ";
-        case 154: return "Ъ";
-        case 155: return "Ы";
-        case 156: return "Ь";
-        case 157: return "Э";
-        case 158: return "Ю";
-        case 159: return "Я";
-        case 160: return "а";
-        case 161: return "б";
-        case 162: return "в";
-        case 163: return "г";
-        case 164: return "д";
-        case 165: return "е";
-        case 166: return "ж";
-        case 167: return "з";
-        case 168: return "и";
-        case 169: return "й";
-        case 170: return "к";
-        case 171: return "л";
-        case 172: return "м";
-        case 173: return "н";
-        case 174: return "о";
-        case 175: return "п";
-        case 224: return "р";
-        case 225: return "с";
-        case 226: return "т";
-        case 227: return "у";
-        case 228: return "ф";
-        case 229: return "х";
-        case 230: return "ц";
-        case 231: return "ч";
-        case 232: return "ш";
-        case 233: return "щ";
-        case 234: return "ъ";
-        case 235: return "ы";
-        case 236: return "ь";
-        case 237: return "э";
-        case 238: return "ю";
-        case 239: return "я";
-        case 240: return "Ё";
-        case 241: return "ё";
-        default: return "";
-    }
-}
+    bool printable = (c >= 32 && c <= 126) || (c >= 128 && c <= 175) || (c >= 224 && c <= 241);
+    if (!printable) return "";
 
-void shannonCoding(const std::string& filename) {
-    std::ifstream file(filename, std::ios::binary);
-    if (!file) {
-        std::cout << "Ошибка открытия файла " << filename << std::endl;
-        std::cout << "Нажмите Enter...";
-        std::cin.get();
-        return;
-    }
-
-    file.seekg(0, std::ios::end);
-    size_t file_size = file.tellg();
-    file.seekg(0, std::ios::beg);
-    
-    char* buffer = new char[file_size];
-    file.read(buffer, file_size);
-    file.close();
+    size_t len;
+    const char* bytes = cp866CharUTF8(c, len);
+    return std::string(bytes, len);
+}
 
-    if (file_size == 0) {
-        std::cout << "Файл пуст.\n";
-        std::cout << "Нажмите Enter...";
-        std::cin.get();
-        delete[] buffer;
-        return;
-    }
+bool buildShannonCode(const char* buffer, size_t size, ShannonCode& result) {
+    INSTR_TIMER("shannon.build");
+    result.symbol_count = 0;
+    result.file_size = size;
+    result.avg_length = 0.0;
+    result.entropy = 0.0;
+    if (size == 0) return false;
 
     int freq[MAX_SYMBOLS] = {0};
-    for (size_t i = 0; i < file_size; ++i) {
+    for (size_t i = 0; i < size; ++i) {
         unsigned char c = static_cast<unsigned char>(buffer[i]);
         freq[c]++;
     }
 
-    SymbolInfo symbols[MAX_SYMBOLS];
+    SymbolInfo* symbols = result.symbols;
     int symbol_count = 0;
     
     for (int i = 0; i < MAX_SYMBOLS; ++i) {
@@ -137,23 +47,21 @@ void shannonCoding(const std::string& filename) {
             symbol_count++;
         }
     }
+    result.symbol_count = symbol_count;
 
     std::sort(symbols, symbols + symbol_count, [](const SymbolInfo& a, const SymbolInfo& b) {
         return a.freq > b.freq;
     });
 
-    double* P = new double[symbol_count];
-    double* Q = new double[symbol_count + 1];
+    double* P = result.P;
+    double Q[MAX_SYMBOLS + 1];
     
     Q[0] = 0.0;
     for (int i = 0; i < symbol_count; ++i) {
-        P[i] = static_cast<double>(symbols[i].freq) / file_size;
+        P[i] = static_cast<double>(symbols[i].freq) / size;
         Q[i + 1] = Q[i] + P[i];
     }
 
-    double avg_length = 0.0;
-    double entropy = 0.0;
-    
     for (int i = 0; i < symbol_count; ++i) {
         double p = P[i];
         
@@ -176,36 +84,95 @@ void shannonCoding(const std::string& filename) {
         strncpy(symbols[i].code, code.c_str(), MAX_CODE_LEN - 1);
         symbols[i].code[MAX_CODE_LEN - 1] = '\0';
         
-        avg_length += p * L;
+        result.avg_length += p * L;
         if (p > 0.0) {
-            entropy -= p * std::log2(p);
+            result.entropy -= p * std::log2(p);
         }
     }
+    return true;
+}
 
-    system("clear");
+bool readWholeFile(const std::string& filename, std::vector<char>& buffer) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) return false;
 
-    std::cout << "╔═════════════════════════════════════════════════════════════════════════╗\n";
-    std::cout << "║                     СТАТИЧЕСКОЕ КОДИРОВАНИЕ ШЕННОНА                     ║\n";
-    std::cout << "╠═════════════════════════════════════════════════════════════════════════╣\n";
-    std::cout << "║ Символ (код)  Частота   Вероятность    Кодовое слово         Длина      ║\n";
-    std::cout << "╠═════════════════════════════════════════════════════════════════════════╣\n";
+    file.seekg(0, std::ios::end);
+    size_t file_size = file.tellg();
+    file.seekg(0, std::ios::beg);
+
+    buffer.resize(file_size);
+    file.read(buffer.data(), file_size);
+    return true;
+}
+
+bool readWholeFiles(const std::vector<std::string>& filenames, std::vector<char>& buffer, std::string& failed) {
+    if (filenames.size() == 1) {
+        if (readWholeFile(filenames[0], buffer)) return true;
+        failed = filenames[0];
+        return false;
+    }
+
+    buffer.clear();
+    std::vector<char> part;
+    for (const std::string& filename : filenames) {
+        if (!readWholeFile(filename, part)) {
+            failed = filename;
+            return false;
+        }
+        buffer.insert(buffer.end(), part.begin(), part.end());
+    }
+    return true;
+}
+
+void shannonCoding(const std::vector<std::string>& filenames) {
+    std::vector<char> buffer;
+    std::string failed;
+    if (!readWholeFiles(filenames, buffer, failed)) {
+        std::cout << "Ошибка открытия файла " << failed << std::endl;
+        std::cout << "Нажмите Enter...";
+        std::cin.get();
+        return;
+    }
+
+    ShannonCode* result = new ShannonCode;
+    if (!buildShannonCode(buffer.data(), buffer.size(), *result)) {
+        std::cout << "Файл пуст.\n";
+        std::cout << "Нажмите Enter...";
+        std::cin.get();
+        delete result;
+        return;
+    }
+
+    const SymbolInfo* symbols = result->symbols;
+    const double* P = result->P;
+    int symbol_count = result->symbol_count;
+    double avg_length = result->avg_length;
+    double entropy = result->entropy;
+
+    std::ostringstream table;
+
+    table << "╔═════════════════════════════════════════════════════════════════════════╗\n";
+    table << "║                     СТАТИЧЕСКОЕ КОДИРОВАНИЕ ШЕННОНА                     ║\n";
+    table << "╠═════════════════════════════════════════════════════════════════════════╣\n";
+    table << "║ Символ (код)  Частота   Вероятность    Кодовое слово         Длина      ║\n";
+    table << "╠═════════════════════════════════════════════════════════════════════════╣\n";
 
     for (int i = 0; i < symbol_count; ++i) {
         unsigned char c = symbols[i].symbol;
         std::string display = cp866ToChar(c);
         
         if (!display.empty()) {
-            std::cout << "║  '" << display << "' (" << std::setw(3) << (int)c << ") "
-                      << std::setw(8) << symbols[i].freq << " "
-                      << std::setw(14) << std::fixed << std::setprecision(6) << P[i] << " "
-                      << std::setw(20) << symbols[i].code << " "
-                      << std::setw(6) << symbols[i].code_len << "    ║\n";
+            table << "║  '" << display << "' (" << std::setw(3) << (int)c << ") "
+                  << std::setw(8) << symbols[i].freq << " "
+                  << std::setw(14) << std::fixed << std::setprecision(6) << P[i] << " "
+                  << std::setw(20) << symbols[i].code << " "
+                  << std::setw(6) << symbols[i].code_len << "    ║\n";
         } else {
-            std::cout << "║      (" << std::setw(3) << (int)c << ") "
-                      << std::setw(8) << symbols[i].freq << " "
-                      << std::setw(14) << std::fixed << std::setprecision(6) << P[i] << " "
-                      << std::setw(20) << symbols[i].code << " "
-                      << std::setw(6) << symbols[i].code_len << "    ║\n";
+            table << "║      (" << std::setw(3) << (int)c << ") "
+                  << std::setw(8) << symbols[i].freq << " "
+                  << std::setw(14) << std::fixed << std::setprecision(6) << P[i] << " "
+                  << std::setw(20) << symbols[i].code << " "
+                  << std::setw(6) << symbols[i].code_len << "    ║\n";
         }
     }
 
@@ -214,17 +181,20 @@ void shannonCoding(const std::string& filename) {
         prob_sum += P[i];
     }
 
-    std::cout << "╠═════════════════════════════════════════════════════════════════════════╣\n";
-    std::cout << "║ Сумма вероятностей: " << std::setw(49) << std::fixed << std::setprecision(6) << prob_sum << " ║\n";
-    std::cout << "║ Средняя длина кодового слова: " << std::setw(36) << std::fixed << std::setprecision(6) << avg_length << " бит ║\n";
-    std::cout << "║ Энтропия исходного файла: " << std::setw(39) << std::fixed << std::setprecision(6) << entropy << " бит ║\n";
-    std::cout << "║ Разница (длина - энтропия): " << std::setw(37) << std::fixed << std::setprecision(6) << (avg_length - entropy) << " бит ║\n";
-    std::cout << "╚═════════════════════════════════════════════════════════════════════════╝\n";
+    table << "╠═════════════════════════════════════════════════════════════════════════╣\n";
+    table << "║ Сумма вероятностей: " << std::setw(49) << std::fixed << std::setprecision(6) << prob_sum << " ║\n";
+    table << "║ Средняя длина кодового слова: " << std::setw(36) << std::fixed << std::setprecision(6) << avg_length << " бит ║\n";
+    table << "║ Энтропия исходного файла: " << std::setw(39) << std::fixed << std::setprecision(6) << entropy << " бит ║\n";
+    table << "║ Разница (длина - энтропия): " << std::setw(37) << std::fixed << std::setprecision(6) << (avg_length - entropy) << " бит ║\n";
+    table << "╚═════════════════════════════════════════════════════════════════════════╝\n";
+
+    table << "\nНажмите Enter для возврата в меню...";
 
-    std::cout << "\nНажмите Enter для возврата в меню...";
+    std::string screen;
+    beginScreen(screen);
+    screen += table.str();
+    flushScreen(screen);
     std::cin.get();
 
-    delete[] buffer;
-    delete[] P;
-    delete[] Q;
+    delete result;
 }
\ No newline at end of file
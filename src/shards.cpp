@@ -0,0 +1,83 @@
+#include "shards.h"
+#include "instrument.h"
+#include <algorithm>
+#include <thread>
+
+bool loadShardedDatabase(const std::vector<std::string>& files, std::vector<Record>& db,
+                         std::vector<DatabaseShard>& shards) {
+    INSTR_TIMER("shards.load");
+    shards.clear();
+    size_t total = 0;
+    for (const std::string& filename : files) {
+        std::ifstream file(filename, std::ios::binary | std::ios::ate);
+        if (!file) {
+            std::cerr << "Ошибка открытия файла " << filename << std::endl;
+            return false;
+        }
+        size_t count = static_cast<size_t>(file.tellg()) / sizeof(Record);
+        shards.push_back({filename, total, count});
+        total += count;
+    }
+
+    db.assign(total, Record{});
+    std::vector<char> loaded(shards.size(), 0);
+    std::vector<std::thread> loaders;
+    for (size_t i = 0; i < shards.size(); ++i) {
+        loaders.emplace_back([&db, &shards, &loaded, i] {
+            std::ifstream file(shards[i].filename, std::ios::binary);
+            loaded[i] = file.read(reinterpret_cast<char*>(db.data() + shards[i].first),
+                                  shards[i].count * sizeof(Record)) ? 1 : 0;
+        });
+    }
+    for (std::thread& loader : loaders) loader.join();
+
+    for (size_t i = 0; i < shards.size(); ++i) {
+        if (!loaded[i]) {
+            std::cerr << "Ошибка чтения файла " << shards[i].filename << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+void mergeSortedShards(std::vector<Record*>& indices, const std::vector<DatabaseShard>& shards) {
+    INSTR_TIMER("shards.merge");
+    auto less = [](const Record* a, const Record* b) { return SurnameIndexKey::compare(*a, *b) < 0; };
+    std::vector<size_t> bounds;
+    for (const DatabaseShard& shard : shards) bounds.push_back(shard.first);
+    bounds.push_back(indices.size());
+
+    std::vector<Record*> merged(indices.size());
+    while (bounds.size() > 2) {
+        std::vector<size_t> next;
+        for (size_t i = 0; i + 1 < bounds.size(); i += 2) {
+            next.push_back(bounds[i]);
+            size_t mid = bounds[i + 1];
+            size_t end = i + 2 < bounds.size() ? bounds[i + 2] : mid;
+            std::merge(indices.begin() + bounds[i], indices.begin() + mid, indices.begin() + mid,
+                       indices.begin() + end, merged.begin() + bounds[i], less);
+        }
+        next.push_back(indices.size());
+        indices.swap(merged);
+        bounds.swap(next);
+    }
+}
+
+void sortShardedIndex(std::vector<Record*>& indices, const std::vector<DatabaseShard>& shards, SortMethod method) {
+    if (shards.size() <= 1) {
+        sortSurnameIndex(indices, method);
+        return;
+    }
+
+    std::vector<std::thread> sorters;
+    for (const DatabaseShard& shard : shards) {
+        sorters.emplace_back([&indices, &shard, method] {
+            std::vector<Record*> part(indices.begin() + shard.first, indices.begin() + shard.first + shard.count);
+            sortSurnameIndex(part, method);
+            std::copy(part.begin(), part.end(), indices.begin() + shard.first);
+        });
+    }
+    for (std::thread& sorter : sorters) sorter.join();
+
+    mergeSortedShards(indices, shards);
+}
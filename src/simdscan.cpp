@@ -0,0 +1,349 @@
+#include "simdscan.h"
+#include "instrument.h"
+#include <algorithm>
+#include <cstring>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define COURSEWORK_SCAN_X86
+#include <immintrin.h>
+#endif
+
+#define SCAN_MAX_CHUNKS 4
+
+struct TextPattern {
+    size_t chunks;
+    unsigned char key[SCAN_MAX_CHUNKS * 16];
+    unsigned char keyMask[SCAN_MAX_CHUNKS * 16];
+    unsigned char padMask[SCAN_MAX_CHUNKS * 16];
+    unsigned char ignoreMask[SCAN_MAX_CHUNKS * 16];
+};
+
+ScanIsa detectScanIsa() {
+#if defined(COURSEWORK_SCAN_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SCAN_AVX2;
+    if (__builtin_cpu_supports("sse2")) return SCAN_SSE2;
+#endif
+    return SCAN_SCALAR;
+}
+
+static ScanIsa& scanIsaSetting() {
+    static ScanIsa isa = detectScanIsa();
+    return isa;
+}
+
+ScanIsa activeScanIsa() {
+    return scanIsaSetting();
+}
+
+void setScanIsa(ScanIsa isa) {
+    scanIsaSetting() = std::min(isa, detectScanIsa());
+}
+
+const char* scanIsaName(ScanIsa isa) {
+    switch (isa) {
+        case SCAN_AVX2: return "avx2";
+        case SCAN_SSE2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+uint64_t rangeWordScalar(const int16_t* values, size_t count, int low, unsigned span) {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < count; ++i) {
+        bits |= static_cast<uint64_t>(static_cast<unsigned>(values[i] - low) <= span) << i;
+    }
+    return bits;
+}
+
+#if defined(COURSEWORK_SCAN_X86)
+uint64_t rangeWordSSE2(const int16_t* values, __m128i lowV, __m128i highV) {
+    uint64_t bits = 0;
+    for (int k = 0; k < 4; ++k) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + 16 * k));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + 16 * k + 8));
+        __m128i outA = _mm_or_si128(_mm_cmplt_epi16(a, lowV), _mm_cmpgt_epi16(a, highV));
+        __m128i outB = _mm_or_si128(_mm_cmplt_epi16(b, lowV), _mm_cmpgt_epi16(b, highV));
+        unsigned mask = ~_mm_movemask_epi8(_mm_packs_epi16(outA, outB)) & 0xFFFFu;
+        bits |= static_cast<uint64_t>(mask) << (16 * k);
+    }
+    return bits;
+}
+
+__attribute__((target("avx2")))
+void filterRangeAVX2(const int16_t* column, size_t words, int low, int high, uint64_t* bitmap) {
+    __m256i lowV = _mm256_set1_epi16(static_cast<int16_t>(low));
+    __m256i highV = _mm256_set1_epi16(static_cast<int16_t>(high));
+    for (size_t w = 0; w < words; ++w) {
+        const int16_t* values = column + w * 64;
+        uint64_t bits = 0;
+        for (int k = 0; k < 2; ++k) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + 32 * k));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + 32 * k + 16));
+            __m256i outA = _mm256_or_si256(_mm256_cmpgt_epi16(lowV, a), _mm256_cmpgt_epi16(a, highV));
+            __m256i outB = _mm256_or_si256(_mm256_cmpgt_epi16(lowV, b), _mm256_cmpgt_epi16(b, highV));
+            __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(outA, outB), 0xD8);
+            uint32_t mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(packed));
+            bits |= static_cast<uint64_t>(mask) << (32 * k);
+        }
+        bitmap[w] = bits;
+    }
+}
+#endif
+
+void filterRangeBitmap(const int16_t* column, size_t rows, int low, int high, std::vector<uint64_t>& bitmap) {
+    INSTR_TIMER("scan.range");
+    bitmap.assign((rows + 63) / 64, 0);
+    low = std::max(low, static_cast<int>(INT16_MIN));
+    high = std::min(high, static_cast<int>(INT16_MAX));
+    if (low > high) return;
+
+    unsigned span = static_cast<unsigned>(high - low);
+    size_t words = rows / 64;
+    ScanIsa isa = activeScanIsa();
+
+#if defined(COURSEWORK_SCAN_X86)
+    if (isa == SCAN_AVX2) {
+        filterRangeAVX2(column, words, low, high, bitmap.data());
+    } else if (isa == SCAN_SSE2) {
+        __m128i lowV = _mm_set1_epi16(static_cast<int16_t>(low));
+        __m128i highV = _mm_set1_epi16(static_cast<int16_t>(high));
+        for (size_t w = 0; w < words; ++w) bitmap[w] = rangeWordSSE2(column + w * 64, lowV, highV);
+    } else
+#endif
+    {
+        (void)isa;
+        for (size_t w = 0; w < words; ++w) bitmap[w] = rangeWordScalar(column + w * 64, 64, low, span);
+    }
+
+    if (rows % 64 != 0) bitmap[words] = rangeWordScalar(column + words * 64, rows % 64, low, span);
+}
+
+bool textMatchScalar(const char* field, size_t width, const char* key, size_t keyLen, bool prefix) {
+    if (memcmp(field, key, keyLen) != 0) return false;
+    if (prefix) return true;
+    for (size_t i = keyLen; i < width; ++i) {
+        if (field[i] != ' ' && field[i] != '\0') return false;
+    }
+    return true;
+}
+
+void buildTextPattern(TextPattern& pattern, size_t width, const char* key, size_t keyLen, bool prefix) {
+    pattern.chunks = (width + 15) / 16;
+    size_t total = pattern.chunks * 16;
+    memset(pattern.key, 0, sizeof(pattern.key));
+    for (size_t i = 0; i < total; ++i) {
+        bool isKey = i < keyLen;
+        bool isPad = !prefix && i >= keyLen && i < width;
+        if (isKey) pattern.key[i] = static_cast<unsigned char>(key[i]);
+        pattern.keyMask[i] = isKey ? 0xFF : 0;
+        pattern.padMask[i] = isPad ? 0xFF : 0;
+        pattern.ignoreMask[i] = (!isKey && !isPad) ? 0xFF : 0;
+    }
+}
+
+#if defined(COURSEWORK_SCAN_X86)
+template <size_t Chunks>
+void filterTextSSE2(const char* column, size_t width, size_t rows, const TextPattern& pattern, uint64_t* bitmap) {
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i zero = _mm_setzero_si128();
+    __m128i key[SCAN_MAX_CHUNKS], keyMask[SCAN_MAX_CHUNKS], padMask[SCAN_MAX_CHUNKS], ignore[SCAN_MAX_CHUNKS];
+    for (size_t c = 0; c < Chunks; ++c) {
+        key[c] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern.key + 16 * c));
+        keyMask[c] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern.keyMask + 16 * c));
+        padMask[c] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern.padMask + 16 * c));
+        ignore[c] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern.ignoreMask + 16 * c));
+    }
+
+    uint64_t bits = 0;
+    for (size_t row = 0; row < rows; ++row) {
+        const char* field = column + row * width;
+        int match = 0xFFFF;
+        for (size_t c = 0; c < Chunks; ++c) {
+            __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(field + 16 * c));
+            __m128i isPad = _mm_or_si128(_mm_cmpeq_epi8(data, space), _mm_cmpeq_epi8(data, zero));
+            __m128i ok = _mm_or_si128(_mm_or_si128(_mm_and_si128(_mm_cmpeq_epi8(data, key[c]), keyMask[c]),
+                                                   _mm_and_si128(isPad, padMask[c])), ignore[c]);
+            match &= _mm_movemask_epi8(ok);
+        }
+        bits |= static_cast<uint64_t>(match == 0xFFFF) << (row % 64);
+        if (row % 64 == 63) {
+            bitmap[row / 64] = bits;
+            bits = 0;
+        }
+    }
+    if (rows % 64 != 0) bitmap[rows / 64] = bits;
+}
+
+template <size_t Chunks>
+__attribute__((target("avx2")))
+void filterTextAVX2(const char* column, size_t width, size_t rows, const TextPattern& pattern, uint64_t* bitmap) {
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i zero = _mm256_setzero_si256();
+    const size_t chunks = Chunks;
+    __m256i key[SCAN_MAX_CHUNKS / 2], keyMask[SCAN_MAX_CHUNKS / 2], padMask[SCAN_MAX_CHUNKS / 2], ignore[SCAN_MAX_CHUNKS / 2];
+    for (size_t c = 0; c < chunks; ++c) {
+        key[c] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pattern.key + 32 * c));
+        keyMask[c] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pattern.keyMask + 32 * c));
+        padMask[c] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pattern.padMask + 32 * c));
+        ignore[c] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pattern.ignoreMask + 32 * c));
+    }
+
+    uint64_t bits = 0;
+    for (size_t row = 0; row < rows; ++row) {
+        const char* field = column + row * width;
+        uint32_t match = 0xFFFFFFFFu;
+        for (size_t c = 0; c < chunks; ++c) {
+            __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(field + 32 * c));
+            __m256i isPad = _mm256_or_si256(_mm256_cmpeq_epi8(data, space), _mm256_cmpeq_epi8(data, zero));
+            __m256i ok = _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(_mm256_cmpeq_epi8(data, key[c]), keyMask[c]),
+                                                         _mm256_and_si256(isPad, padMask[c])), ignore[c]);
+            match &= static_cast<uint32_t>(_mm256_movemask_epi8(ok));
+        }
+        bits |= static_cast<uint64_t>(match == 0xFFFFFFFFu) << (row % 64);
+        if (row % 64 == 63) {
+            bitmap[row / 64] = bits;
+            bits = 0;
+        }
+    }
+    if (rows % 64 != 0) bitmap[rows / 64] = bits;
+}
+#endif
+
+void filterTextBitmap(const char* column, size_t width, size_t rows, const char* key, size_t keyLen,
+                      bool prefix, std::vector<uint64_t>& bitmap) {
+    INSTR_TIMER("scan.text");
+    bitmap.assign((rows + 63) / 64, 0);
+    if (keyLen > width || width > SCAN_MAX_CHUNKS * 16) return;
+
+    ScanIsa isa = activeScanIsa();
+#if defined(COURSEWORK_SCAN_X86)
+    if (isa != SCAN_SCALAR) {
+        TextPattern pattern;
+        buildTextPattern(pattern, width, key, keyLen, prefix);
+        if (isa == SCAN_AVX2) {
+            size_t padded = ((pattern.chunks + 1) / 2) * 32;
+            for (size_t i = pattern.chunks * 16; i < padded; ++i) {
+                pattern.key[i] = 0;
+                pattern.keyMask[i] = 0;
+                pattern.padMask[i] = 0;
+                pattern.ignoreMask[i] = 0xFF;
+            }
+            if (pattern.chunks <= 2) filterTextAVX2<1>(column, width, rows, pattern, bitmap.data());
+            else filterTextAVX2<2>(column, width, rows, pattern, bitmap.data());
+        } else {
+            switch (pattern.chunks) {
+                case 1: filterTextSSE2<1>(column, width, rows, pattern, bitmap.data()); break;
+                case 2: filterTextSSE2<2>(column, width, rows, pattern, bitmap.data()); break;
+                case 3: filterTextSSE2<3>(column, width, rows, pattern, bitmap.data()); break;
+                default: filterTextSSE2<4>(column, width, rows, pattern, bitmap.data()); break;
+            }
+        }
+        return;
+    }
+#endif
+    (void)isa;
+    for (size_t row = 0; row < rows; ++row) {
+        bool match = textMatchScalar(column + row * width, width, key, keyLen, prefix);
+        bitmap[row / 64] |= static_cast<uint64_t>(match) << (row % 64);
+    }
+}
+
+bool rowContains(const char* field, size_t width, const char* needle, size_t len) {
+    for (size_t off = 0; off + len <= width; ++off) {
+        if (field[off] == needle[0] && memcmp(field + off, needle, len) == 0) return true;
+    }
+    return false;
+}
+
+bool candidateMatches(const char* column, size_t width, size_t pos, const char* needle, size_t len) {
+    size_t off = pos % width;
+    return off + len <= width && memcmp(column + pos + 1, needle + 1, len - 1) == 0;
+}
+
+#if defined(COURSEWORK_SCAN_X86)
+void filterSubstringSSE2(const char* column, size_t width, size_t rows, const char* needle, size_t len, uint64_t* bitmap) {
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[len - 1]);
+    size_t limit = rows * width - len + 1;
+    for (size_t i = 0; i < limit; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(column + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(column + i + len - 1));
+        unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last)));
+        while (mask != 0) {
+            size_t pos = i + __builtin_ctz(mask);
+            mask &= mask - 1;
+            if (pos >= limit) break;
+            if (candidateMatches(column, width, pos, needle, len)) {
+                size_t row = pos / width;
+                bitmap[row / 64] |= uint64_t(1) << (row % 64);
+            }
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+void filterSubstringAVX2(const char* column, size_t width, size_t rows, const char* needle, size_t len, uint64_t* bitmap) {
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[len - 1]);
+    size_t limit = rows * width - len + 1;
+    for (size_t i = 0; i < limit; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(column + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(column + i + len - 1));
+        uint32_t mask = static_cast<uint32_t>(
+            _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last))));
+        while (mask != 0) {
+            size_t pos = i + __builtin_ctz(mask);
+            mask &= mask - 1;
+            if (pos >= limit) break;
+            if (candidateMatches(column, width, pos, needle, len)) {
+                size_t row = pos / width;
+                bitmap[row / 64] |= uint64_t(1) << (row % 64);
+            }
+        }
+    }
+}
+#endif
+
+void filterSubstringBitmap(const char* column, size_t width, size_t rows, const char* needle, size_t len,
+                           std::vector<uint64_t>& bitmap) {
+    INSTR_TIMER("scan.substring");
+    bitmap.assign((rows + 63) / 64, 0);
+    if (len == 0 || len > width || rows == 0) return;
+
+    ScanIsa isa = activeScanIsa();
+#if defined(COURSEWORK_SCAN_X86)
+    if (isa == SCAN_AVX2) {
+        filterSubstringAVX2(column, width, rows, needle, len, bitmap.data());
+        return;
+    }
+    if (isa == SCAN_SSE2) {
+        filterSubstringSSE2(column, width, rows, needle, len, bitmap.data());
+        return;
+    }
+#endif
+    (void)isa;
+    for (size_t row = 0; row < rows; ++row) {
+        bool match = rowContains(column + row * width, width, needle, len);
+        bitmap[row / 64] |= static_cast<uint64_t>(match) << (row % 64);
+    }
+}
+
+void bitmapToRows(const std::vector<uint64_t>& bitmap, size_t rows, std::vector<uint32_t>& out) {
+    out.clear();
+    out.reserve(bitmapCount(bitmap));
+    for (size_t w = 0; w < bitmap.size(); ++w) {
+        uint64_t bits = bitmap[w];
+        while (bits != 0) {
+            size_t row = w * 64 + __builtin_ctzll(bits);
+            if (row >= rows) break;
+            out.push_back(static_cast<uint32_t>(row));
+            bits &= bits - 1;
+        }
+    }
+}
+
+size_t bitmapCount(const std::vector<uint64_t>& bitmap) {
+    size_t count = 0;
+    for (uint64_t bits : bitmap) count += __builtin_popcountll(bits);
+    return count;
+}
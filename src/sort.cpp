@@ -1,28 +1,9 @@
 #include "sort.h"
+#include "instrument.h"
 #include "database.h"
+#include <algorithm>
 int partition(std::vector<Record*>& indices, int left, int right) {
-    int mid = left + (right - left) / 2;
-    Record* pivot_rec = indices[mid];
-    std::string pivot_surname = extractSurname(*pivot_rec);
-
-    int i = left - 1;
-    int j = right + 1;
-
-    while (true) {
-        do {
-            i++;
-        } while (customCompare(extractSurname(*indices[i]), pivot_surname) < 0);
-
-        do {
-            j--;
-        } while (customCompare(extractSurname(*indices[j]), pivot_surname) > 0);
-
-        if (i >= j) {
-            return j;
-        }
-
-        std::swap(indices[i], indices[j]);
-    }
+    return partitionBy<SurnameIndexKey>(indices, left, right);
 }
 
 void quickSortHoare(std::vector<Record*>& indices, int left, int right) {
@@ -37,4 +18,76 @@ void quickSortHoare(std::vector<Record*>& indices, int left, int right) {
             right = split_pos;
         }
     }
-}
\ No newline at end of file
+}
+
+void initIncrementalSort(IncrementalSort& sort, const std::vector<Record*>& indices) {
+    sort.indices = indices;
+    sort.pending.clear();
+    if (indices.size() > 1) sort.pending.emplace_back(0, static_cast<int>(indices.size()) - 1);
+}
+
+void ensureSortedRange(IncrementalSort& sort, int begin, int end) {
+    INSTR_TIMER("sort.incremental");
+    std::vector<std::pair<int, int>> remaining;
+    std::vector<std::pair<int, int>> stack;
+    for (const auto& range : sort.pending) {
+        stack.push_back(range);
+        while (!stack.empty()) {
+            int left = stack.back().first;
+            int right = stack.back().second;
+            stack.pop_back();
+            if (left >= right) continue;
+            if (right < begin || left >= end) {
+                remaining.emplace_back(left, right);
+                continue;
+            }
+            if (right - left < INCREMENTAL_SORT_CUTOFF) {
+                quickSortBy<SurnameIndexKey>(sort.indices, left, right);
+                continue;
+            }
+            int split_pos = partitionBy<SurnameIndexKey>(sort.indices, left, right);
+            stack.emplace_back(split_pos + 1, right);
+            stack.emplace_back(left, split_pos);
+        }
+    }
+    std::sort(remaining.begin(), remaining.end());
+    sort.pending.swap(remaining);
+}
+
+bool incrementalSortDone(const IncrementalSort& sort) {
+    return sort.pending.empty();
+}
+
+bool parseSortMethod(const std::string& name, SortMethod& method) {
+    if (name == "hoare") method = SORT_METHOD_HOARE;
+    else if (name == "adaptive") method = SORT_METHOD_ADAPTIVE;
+    else return false;
+    return true;
+}
+
+void sortSurnameIndex(std::vector<Record*>& indices, SortMethod method) {
+    INSTR_TIMER("sort.surname_index");
+    if (method == SORT_METHOD_ADAPTIVE) adaptiveSortBy<SurnameIndexKey>(indices);
+    else if (!indices.empty()) quickSortHoare(indices, 0, indices.size() - 1);
+}
+
+bool parseSortOrder(const std::string& name, SortOrder& order) {
+    if (name == "surname") order = SORT_SURNAME;
+    else if (name == "surname,year") order = SORT_SURNAME_YEAR;
+    else if (name == "author,title") order = SORT_AUTHOR_TITLE;
+    else if (name == "publisher,pages") order = SORT_PUBLISHER_PAGES;
+    else if (name == "year,pages") order = SORT_YEAR_PAGES;
+    else return false;
+    return true;
+}
+
+void sortRecords(std::vector<Record*>& indices, SortOrder order) {
+    INSTR_TIMER("sort.records");
+    switch (order) {
+        case SORT_SURNAME: sortRecordsBy<SurnameKey>(indices); break;
+        case SORT_SURNAME_YEAR: sortRecordsBy<SurnameKey, YearKey>(indices); break;
+        case SORT_AUTHOR_TITLE: sortRecordsBy<AuthorKey, TitleKey>(indices); break;
+        case SORT_PUBLISHER_PAGES: sortRecordsBy<PublisherKey, PagesKey>(indices); break;
+        case SORT_YEAR_PAGES: sortRecordsBy<YearKey, PagesKey>(indices); break;
+    }
+}
@@ -0,0 +1,108 @@
+#include "textcache.h"
+#include <algorithm>
+#include <shared_mutex>
+#include <mutex>
+
+namespace {
+
+struct RecordTextCache {
+    const std::vector<Record>* db = nullptr;
+    const Record* base = nullptr;
+    std::vector<RecordTextRef> texts;
+    size_t filled = 0;
+};
+
+}
+
+static RecordTextCache textCache;
+static std::shared_mutex textCacheMutex;
+
+static RecordTextRef decodeRecordText(const Record* rec) {
+    std::shared_ptr<CachedRecordText> text = std::make_shared<CachedRecordText>();
+    text->author = recordFieldText(rec->author, sizeof(rec->author));
+    text->title = recordFieldText(rec->title, sizeof(rec->title));
+    text->publisher = recordFieldText(rec->publisher, sizeof(rec->publisher));
+    return text;
+}
+
+static bool textCacheCurrent() {
+    return textCache.db != nullptr && textCache.base == textCache.db->data() &&
+           textCache.texts.size() == textCache.db->size();
+}
+
+static void syncTextCache() {
+    if (textCache.db == nullptr || textCacheCurrent()) return;
+    if (textCache.base != textCache.db->data() || textCache.db->size() < textCache.texts.size()) {
+        textCache.texts.clear();
+        textCache.filled = 0;
+        textCache.base = textCache.db->data();
+    }
+    textCache.texts.resize(textCache.db->size());
+}
+
+static bool cachedOrdinal(const Record* rec, size_t& ordinal) {
+    if (rec < textCache.base || rec >= textCache.base + textCache.texts.size()) return false;
+    ordinal = rec - textCache.base;
+    return true;
+}
+
+static void storeText(size_t ordinal, RecordTextRef& text) {
+    RecordTextRef& slot = textCache.texts[ordinal];
+    if (slot) {
+        text = slot;
+        return;
+    }
+    slot = text;
+    textCache.filled++;
+}
+
+void attachRecordTextCache(const std::vector<Record>& db) {
+    std::unique_lock<std::shared_mutex> lock(textCacheMutex);
+    if (textCache.db == &db) return;
+    textCache = RecordTextCache();
+    textCache.db = &db;
+    syncTextCache();
+}
+
+RecordTextRef cachedRecordText(const Record* rec) {
+    size_t ordinal;
+    {
+        std::shared_lock<std::shared_mutex> lock(textCacheMutex);
+        if (textCacheCurrent() && cachedOrdinal(rec, ordinal) && textCache.texts[ordinal]) {
+            return textCache.texts[ordinal];
+        }
+    }
+
+    RecordTextRef text = decodeRecordText(rec);
+    std::unique_lock<std::shared_mutex> lock(textCacheMutex);
+    syncTextCache();
+    if (cachedOrdinal(rec, ordinal)) storeText(ordinal, text);
+    return text;
+}
+
+void warmRecordTextCache(const std::vector<Record>& db, const std::atomic<bool>& stop) {
+    attachRecordTextCache(db);
+    std::vector<RecordTextRef> chunk;
+    chunk.reserve(RECORD_TEXT_WARM_CHUNK);
+    for (size_t begin = 0; begin < db.size() && !stop; begin += RECORD_TEXT_WARM_CHUNK) {
+        size_t end = std::min(db.size(), begin + RECORD_TEXT_WARM_CHUNK);
+        chunk.clear();
+        for (size_t i = begin; i < end; ++i) chunk.push_back(decodeRecordText(&db[i]));
+
+        std::unique_lock<std::shared_mutex> lock(textCacheMutex);
+        syncTextCache();
+        if (textCache.db != &db) return;
+        for (size_t i = begin; i < end && i < textCache.texts.size(); ++i) storeText(i, chunk[i - begin]);
+    }
+}
+
+void clearRecordTextCache() {
+    std::unique_lock<std::shared_mutex> lock(textCacheMutex);
+    std::fill(textCache.texts.begin(), textCache.texts.end(), RecordTextRef());
+    textCache.filled = 0;
+}
+
+size_t recordTextCacheSize() {
+    std::shared_lock<std::shared_mutex> lock(textCacheMutex);
+    return textCache.filled;
+}
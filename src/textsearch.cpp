@@ -0,0 +1,192 @@
+#include "textsearch.h"
+#include "search.h"
+#include "simdscan.h"
+#include "transcode.h"
+#include "instrument.h"
+#include <algorithm>
+
+void initTextSearchIndex(TextSearchIndex& index, const std::vector<Record>& db, const std::vector<Record*>& sorted) {
+    index.db = &db;
+    index.sorted = &sorted;
+    index.rows = 0;
+}
+
+bool isWordByte(unsigned char c) {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= 0x80 && c <= 0xAF) || (c >= 0xE0 && c <= 0xF1);
+}
+
+void foldField(const char* src, size_t width, char* dst) {
+    for (size_t i = 0; i < width; ++i) {
+        dst[i] = static_cast<char>(toUpperCP866(static_cast<unsigned char>(src[i])));
+    }
+}
+
+uint32_t trigramKey(const std::string& padded, size_t pos) {
+    return (static_cast<unsigned char>(padded[pos]) << 16) | (static_cast<unsigned char>(padded[pos + 1]) << 8) |
+           static_cast<unsigned char>(padded[pos + 2]);
+}
+
+std::vector<uint32_t> wordTrigrams(const std::string& word) {
+    std::string padded = "\x01\x01" + word + "\x01\x01";
+    std::vector<uint32_t> grams;
+    for (size_t i = 0; i + 3 <= padded.size(); ++i) grams.push_back(trigramKey(padded, i));
+    std::sort(grams.begin(), grams.end());
+    return grams;
+}
+
+void indexFieldWords(TextSearchIndex& index, std::unordered_map<std::string, uint32_t>& ids,
+                     const char* field, size_t width, uint32_t row) {
+    size_t i = 0;
+    while (i < width) {
+        while (i < width && !isWordByte(static_cast<unsigned char>(field[i]))) i++;
+        size_t start = i;
+        while (i < width && isWordByte(static_cast<unsigned char>(field[i]))) i++;
+        if (i == start) continue;
+
+        std::string word(field + start, i - start);
+        auto found = ids.find(word);
+        uint32_t id;
+        if (found == ids.end()) {
+            id = static_cast<uint32_t>(index.words.size());
+            ids.emplace(word, id);
+            index.words.push_back(word);
+            index.wordRows.emplace_back();
+            for (uint32_t gram : wordTrigrams(word)) index.trigramWords[gram].push_back(id);
+        } else {
+            id = found->second;
+        }
+        std::vector<uint32_t>& rows = index.wordRows[id];
+        if (rows.empty() || rows.back() != row) rows.push_back(row);
+    }
+}
+
+void rebuildTextSearchIndex(TextSearchIndex& index) {
+    INSTR_TIMER("textsearch.build");
+    const std::vector<Record>& db = *index.db;
+    size_t rows = db.size();
+    index.author.assign(rows * sizeof(Record::author) + SCAN_PADDING, '\0');
+    index.title.assign(rows * sizeof(Record::title) + SCAN_PADDING, '\0');
+    index.rank.assign(rows, 0);
+    index.words.clear();
+    index.wordRows.clear();
+    index.trigramWords.clear();
+
+    std::unordered_map<std::string, uint32_t> ids;
+    for (size_t row = 0; row < rows; ++row) {
+        char* author = &index.author[row * sizeof(Record::author)];
+        char* title = &index.title[row * sizeof(Record::title)];
+        foldField(db[row].author, sizeof(Record::author), author);
+        foldField(db[row].title, sizeof(Record::title), title);
+        indexFieldWords(index, ids, author, sizeof(Record::author), static_cast<uint32_t>(row));
+        indexFieldWords(index, ids, title, sizeof(Record::title), static_cast<uint32_t>(row));
+    }
+
+    const std::vector<Record*>& sorted = *index.sorted;
+    for (size_t i = 0; i < sorted.size(); ++i) index.rank[sorted[i] - db.data()] = static_cast<uint32_t>(i);
+    index.rows = rows;
+}
+
+void buildTextSearchIndex(TextSearchIndex& index) {
+    std::lock_guard<std::mutex> lock(index.mutex);
+    if (index.rows != index.db->size() || index.rank.empty()) rebuildTextSearchIndex(index);
+}
+
+std::string foldSearchText(const std::string& utf8) {
+    std::string text = utf8ToCP866(utf8);
+    for (char& c : text) c = static_cast<char>(toUpperCP866(static_cast<unsigned char>(c)));
+    return text;
+}
+
+Queue rowsToQueue(const TextSearchIndex& index, std::vector<uint32_t>& rows) {
+    std::sort(rows.begin(), rows.end(), [&index](uint32_t a, uint32_t b) { return index.rank[a] < index.rank[b]; });
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+    Queue result;
+    initQueue(result);
+    for (uint32_t row : rows) enqueue(result, const_cast<Record*>(&(*index.db)[row]));
+    return result;
+}
+
+Queue substringSearch(TextSearchIndex& index, const std::string& text) {
+    INSTR_TIMER("textsearch.substring");
+    buildTextSearchIndex(index);
+    std::string needle = foldSearchText(text);
+
+    std::vector<uint64_t> inAuthor, inTitle;
+    filterSubstringBitmap(index.author.data(), sizeof(Record::author), index.rows, needle.data(), needle.size(), inAuthor);
+    filterSubstringBitmap(index.title.data(), sizeof(Record::title), index.rows, needle.data(), needle.size(), inTitle);
+    for (size_t w = 0; w < inAuthor.size(); ++w) inAuthor[w] |= inTitle[w];
+
+    std::vector<uint32_t> rows;
+    bitmapToRows(inAuthor, index.rows, rows);
+    return rowsToQueue(index, rows);
+}
+
+int editDistance(const std::string& a, const std::string& b, int limit) {
+    int n = a.size();
+    int m = b.size();
+    if (std::abs(n - m) > limit) return limit + 1;
+
+    std::vector<int> prev(m + 1), cur(m + 1);
+    for (int j = 0; j <= m; ++j) prev[j] = j;
+    for (int i = 1; i <= n; ++i) {
+        cur[0] = i;
+        int best = cur[0];
+        for (int j = 1; j <= m; ++j) {
+            int cost = a[i - 1] == b[j - 1] ? 0 : 1;
+            cur[j] = std::min({prev[j] + 1, cur[j - 1] + 1, prev[j - 1] + cost});
+            best = std::min(best, cur[j]);
+        }
+        if (best > limit) return limit + 1;
+        prev.swap(cur);
+    }
+    return std::min(prev[m], limit + 1);
+}
+
+int defaultFuzzyDistance(const std::string& word) {
+    size_t letters = utf8ToCP866(word).size();
+    return letters <= 4 ? 1 : 2;
+}
+
+Queue fuzzySearch(TextSearchIndex& index, const std::string& word, int maxDistance) {
+    INSTR_TIMER("textsearch.fuzzy");
+    buildTextSearchIndex(index);
+    std::string query = foldSearchText(word);
+    std::vector<uint32_t> rows;
+    if (query.empty()) return rowsToQueue(index, rows);
+
+    std::vector<uint32_t> grams = wordTrigrams(query);
+    int threshold = static_cast<int>(grams.size()) - 3 * maxDistance;
+
+    std::vector<uint32_t> candidates;
+    if (threshold > 0) {
+        std::unordered_map<uint32_t, int> shared;
+        for (size_t i = 0; i < grams.size();) {
+            size_t next = i;
+            while (next < grams.size() && grams[next] == grams[i]) next++;
+            int queryCount = static_cast<int>(next - i);
+            auto found = index.trigramWords.find(grams[i]);
+            i = next;
+            if (found == index.trigramWords.end()) continue;
+            const std::vector<uint32_t>& ids = found->second;
+            for (size_t j = 0; j < ids.size();) {
+                size_t run = j;
+                while (run < ids.size() && ids[run] == ids[j]) run++;
+                shared[ids[j]] += std::min(queryCount, static_cast<int>(run - j));
+                j = run;
+            }
+        }
+        for (const auto& entry : shared) {
+            if (entry.second >= threshold) candidates.push_back(entry.first);
+        }
+    } else {
+        for (uint32_t id = 0; id < index.words.size(); ++id) candidates.push_back(id);
+    }
+
+    for (uint32_t id : candidates) {
+        if (editDistance(query, index.words[id], maxDistance) <= maxDistance) {
+            rows.insert(rows.end(), index.wordRows[id].begin(), index.wordRows[id].end());
+        }
+    }
+    return rowsToQueue(index, rows);
+}
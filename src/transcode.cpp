@@ -0,0 +1,157 @@
+#include "transcode.h"
+#include "instrument.h"
+#include <cstdint>
+#include <unordered_map>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+static const uint16_t kCP866High[128] = {
+    0x0410, 0x0411, 0x0412, 0x0413, 0x0414, 0x0415, 0x0416, 0x0417,
+    0x0418, 0x0419, 0x041A, 0x041B, 0x041C, 0x041D, 0x041E, 0x041F,
+    0x0420, 0x0421, 0x0422, 0x0423, 0x0424, 0x0425, 0x0426, 0x0427,
+    0x0428, 0x0429, 0x042A, 0x042B, 0x042C, 0x042D, 0x042E, 0x042F,
+    0x0430, 0x0431, 0x0432, 0x0433, 0x0434, 0x0435, 0x0436, 0x0437,
+    0x0438, 0x0439, 0x043A, 0x043B, 0x043C, 0x043D, 0x043E, 0x043F,
+    0x2591, 0x2592, 0x2593, 0x2502, 0x2524, 0x2561, 0x2562, 0x2556,
+    0x2555, 0x2563, 0x2551, 0x2557, 0x255D, 0x255C, 0x255B, 0x2510,
+    0x2514, 0x2534, 0x252C, 0x251C, 0x2500, 0x253C, 0x255E, 0x255F,
+    0x255A, 0x2554, 0x2569, 0x2566, 0x2560, 0x2550, 0x256C, 0x2567,
+    0x2568, 0x2564, 0x2565, 0x2559, 0x2558, 0x2552, 0x2553, 0x256B,
+    0x256A, 0x2518, 0x250C, 0x2588, 0x2584, 0x258C, 0x2590, 0x2580,
+    0x0440, 0x0441, 0x0442, 0x0443, 0x0444, 0x0445, 0x0446, 0x0447,
+    0x0448, 0x0449, 0x044A, 0x044B, 0x044C, 0x044D, 0x044E, 0x044F,
+    0x0401, 0x0451, 0x0404, 0x0454, 0x0407, 0x0457, 0x040E, 0x045E,
+    0x00B0, 0x2219, 0x00B7, 0x221A, 0x2116, 0x00A4, 0x25A0, 0x00A0
+};
+
+struct CP866Table {
+    char bytes[256][4];
+    unsigned char length[256];
+    uint16_t codePoint[256];
+    std::unordered_map<uint32_t, unsigned char> reverse;
+
+    CP866Table() {
+        for (int c = 0; c < 256; ++c) {
+            uint32_t cp = c < 128 ? c : kCP866High[c - 128];
+            codePoint[c] = static_cast<uint16_t>(cp);
+            unsigned char* out = reinterpret_cast<unsigned char*>(bytes[c]);
+            if (cp < 0x80) {
+                out[0] = cp;
+                length[c] = 1;
+            } else if (cp < 0x800) {
+                out[0] = 0xC0 | (cp >> 6);
+                out[1] = 0x80 | (cp & 0x3F);
+                length[c] = 2;
+            } else {
+                out[0] = 0xE0 | (cp >> 12);
+                out[1] = 0x80 | ((cp >> 6) & 0x3F);
+                out[2] = 0x80 | (cp & 0x3F);
+                length[c] = 3;
+            }
+            reverse[cp] = static_cast<unsigned char>(c);
+        }
+    }
+};
+
+static const CP866Table& cp866Table() {
+    static const CP866Table table;
+    return table;
+}
+
+const char* cp866CharUTF8(unsigned char c, size_t& len) {
+    const CP866Table& table = cp866Table();
+    len = table.length[c];
+    return table.bytes[c];
+}
+
+size_t transcodeCP866ToUTF8(const char* src, size_t len, char* dst) {
+    INSTR_COUNT("transcode.call");
+    const CP866Table& table = cp866Table();
+    char* out = dst;
+    size_t i = 0;
+
+    while (i < len) {
+#if defined(__SSE2__)
+        while (i + 16 <= len) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            if (_mm_movemask_epi8(chunk) != 0) break;
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), chunk);
+            out += 16;
+            i += 16;
+        }
+#endif
+        if (i >= len) break;
+
+        unsigned char c = static_cast<unsigned char>(src[i++]);
+        if (c < 0x80) {
+            *out++ = static_cast<char>(c);
+        } else {
+            const char* bytes = table.bytes[c];
+            out[0] = bytes[0];
+            out[1] = bytes[1];
+            out[2] = bytes[2];
+            out += table.length[c];
+        }
+    }
+    return out - dst;
+}
+
+std::string cp866ToUTF8(const char* src, size_t len) {
+    std::string out(len * CP866_UTF8_MAX_BYTES, '\0');
+    out.resize(transcodeCP866ToUTF8(src, len, &out[0]));
+    return out;
+}
+
+void transcodeColumn(const std::vector<Record>& db, RecordField field, std::vector<std::string>& out) {
+    out.clear();
+    out.reserve(db.size());
+    for (const Record& rec : db) {
+        switch (field) {
+            case FIELD_AUTHOR: out.push_back(recordFieldText(rec.author, sizeof(rec.author))); break;
+            case FIELD_TITLE: out.push_back(recordFieldText(rec.title, sizeof(rec.title))); break;
+            case FIELD_PUBLISHER: out.push_back(recordFieldText(rec.publisher, sizeof(rec.publisher))); break;
+            case FIELD_YEAR: out.push_back(std::to_string(rec.year)); break;
+            case FIELD_PAGES: out.push_back(std::to_string(rec.pages)); break;
+        }
+    }
+}
+
+std::string utf8ToCP866(const std::string& utf8) {
+    const CP866Table& table = cp866Table();
+    std::string out;
+    out.reserve(utf8.size());
+
+    size_t i = 0;
+    while (i < utf8.size()) {
+        unsigned char c = utf8[i];
+        uint32_t cp;
+        size_t n;
+        if (c < 0x80) { cp = c; n = 1; }
+        else if ((c & 0xE0) == 0xC0) { cp = c & 0x1F; n = 2; }
+        else if ((c & 0xF0) == 0xE0) { cp = c & 0x0F; n = 3; }
+        else if ((c & 0xF8) == 0xF0) { cp = c & 0x07; n = 4; }
+        else { out += '?'; i++; continue; }
+
+        if (i + n > utf8.size()) break;
+        for (size_t k = 1; k < n; ++k) cp = (cp << 6) | (static_cast<unsigned char>(utf8[i + k]) & 0x3F);
+        i += n;
+
+        auto it = table.reverse.find(cp);
+        out += it != table.reverse.end() ? static_cast<char>(it->second) : '?';
+    }
+    return out;
+}
+
+int compareCP866(const char* a, size_t alen, const char* b, size_t blen) {
+    const uint16_t* codePoint = cp866Table().codePoint;
+    size_t len = alen < blen ? alen : blen;
+    for (size_t i = 0; i < len; ++i) {
+        if (a[i] == b[i]) continue;
+        uint16_t ca = codePoint[static_cast<unsigned char>(a[i])];
+        uint16_t cb = codePoint[static_cast<unsigned char>(b[i])];
+        return ca < cb ? -1 : 1;
+    }
+    if (alen == blen) return 0;
+    return alen < blen ? -1 : 1;
+}
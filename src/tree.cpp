@@ -1,65 +1,51 @@
 #include "tree.h"
+#include "instrument.h"
+#include "render.h"
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
-#include <map>
+#include <memory_resource>
+#include <new>
 #include <queue>
 #include <cmath>
 #include <climits>
 #include <functional>
 #include <sstream>
 
-TreeNode* createTreeNode(const std::string& key, Record* record, int weight) {
-    TreeNode* node = new TreeNode;
-    node->key = key;
-    node->records.push_back(record);
-    node->weight = weight;
+struct TreeKey {
+    int pages;
+    int weight;
+    int first;
+};
+
+struct KeyedRecord {
+    int pages;
+    int order;
+    Record* record;
+};
+
+TreeNode* createTreeNode(OptimalSearchTree* tree, const TreeKey& key, Record** records) {
+    INSTR_COUNT("tree.node_alloc");
+    void* memory = tree->arena.allocate(sizeof(TreeNode), alignof(TreeNode));
+    TreeNode* node = new (memory) TreeNode;
+    node->key = key.pages;
+    node->records = records + key.first;
+    node->recordCount = key.weight;
+    node->weight = key.weight;
     node->left = nullptr;
     node->right = nullptr;
     return node;
 }
 
-std::string getKeyFromRecord(Record* record) {
-    return std::to_string(record->pages);
-}
-
-std::map<std::string, int> countKeyWeights(Queue& queue) {
-    std::map<std::string, int> weights;
-    QueueNode* current = queue.front;
-    
-    while (current != nullptr) {
-        std::string key = getKeyFromRecord(current->data);
-        weights[key]++;
-        current = current->next;
-    }
-    
-    return weights;
-}
-
-std::vector<std::pair<std::string, int>> createSortedKeyList(const std::map<std::string, int>& weights) {
-    std::vector<std::pair<std::string, int>> keyList;
-    
-    for (const auto& pair : weights) {
-        keyList.push_back({pair.first, pair.second});
-    }
-    
-    std::sort(keyList.begin(), keyList.end(),
-        [](const auto& a, const auto& b) {
-            return std::stoi(a.first) < std::stoi(b.first);
-        });
-    
-    return keyList;
-}
-
-int findMaxWeightIndex(const std::vector<std::pair<std::string, int>>& keyList, int start, int end) {
+int findMaxWeightIndex(const std::pmr::vector<TreeKey>& keyList, int start, int end) {
     if (start > end) return -1;
     
     int maxIndex = start;
-    int maxWeight = keyList[start].second;
+    int maxWeight = keyList[start].weight;
     
     for (int i = start + 1; i <= end; i++) {
-        if (keyList[i].second > maxWeight) {
-            maxWeight = keyList[i].second;
+        if (keyList[i].weight > maxWeight) {
+            maxWeight = keyList[i].weight;
             maxIndex = i;
         }
     }
@@ -67,45 +53,58 @@ int findMaxWeightIndex(const std::vector<std::pair<std::string, int>>& keyList,
     return maxIndex;
 }
 
-TreeNode* buildTreeA1Recursive(const std::vector<std::pair<std::string, int>>& keyList, 
-                              std::map<std::string, std::vector<Record*>>& recordsMap,
-                              int start, int end) {
+TreeNode* buildTreeA1Recursive(OptimalSearchTree* tree, const std::pmr::vector<TreeKey>& keyList,
+                              Record** records, int start, int end) {
     if (start > end) return nullptr;
     
     int maxIndex = findMaxWeightIndex(keyList, start, end);
     if (maxIndex == -1) return nullptr;
     
-    TreeNode* root = createTreeNode(keyList[maxIndex].first, 
-                                   recordsMap[keyList[maxIndex].first][0],
-                                   keyList[maxIndex].second);
+    TreeNode* root = createTreeNode(tree, keyList[maxIndex], records);
     
-    root->records = recordsMap[keyList[maxIndex].first];
-    
-    root->left = buildTreeA1Recursive(keyList, recordsMap, start, maxIndex - 1);
-    root->right = buildTreeA1Recursive(keyList, recordsMap, maxIndex + 1, end);
+    root->left = buildTreeA1Recursive(tree, keyList, records, start, maxIndex - 1);
+    root->right = buildTreeA1Recursive(tree, keyList, records, maxIndex + 1, end);
     
     return root;
 }
 
 OptimalSearchTree* buildOptimalSearchTreeA1(Queue& queue) {
+    INSTR_TIMER("tree.buildA1");
     if (isEmpty(queue)) {
         return nullptr;
     }
-    
-    std::map<std::string, int> weights = countKeyWeights(queue);
-    std::map<std::string, std::vector<Record*>> recordsMap;
-    
-    QueueNode* current = queue.front;
-    while (current != nullptr) {
-        std::string key = getKeyFromRecord(current->data);
-        recordsMap[key].push_back(current->data);
-        current = current->next;
+
+    char scratchBuffer[16384];
+    std::pmr::monotonic_buffer_resource scratch(scratchBuffer, sizeof(scratchBuffer));
+
+    std::pmr::vector<KeyedRecord> keyed(&scratch);
+    keyed.reserve(queue.size);
+    int order = 0;
+    for (QueueNode* current = queue.front; current != nullptr; current = current->next) {
+        keyed.push_back({current->data->pages, order++, current->data});
     }
-    
-    std::vector<std::pair<std::string, int>> keyList = createSortedKeyList(weights);
-    
-    OptimalSearchTree* tree = new OptimalSearchTree;
-    tree->root = buildTreeA1Recursive(keyList, recordsMap, 0, keyList.size() - 1);
+
+    std::sort(keyed.begin(), keyed.end(), [](const KeyedRecord& a, const KeyedRecord& b) {
+        return a.pages != b.pages ? a.pages < b.pages : a.order < b.order;
+    });
+
+    std::pmr::vector<TreeKey> keyList(&scratch);
+    for (size_t i = 0; i < keyed.size(); ++i) {
+        if (keyList.empty() || keyList.back().pages != keyed[i].pages) {
+            keyList.push_back({keyed[i].pages, 0, static_cast<int>(i)});
+        }
+        keyList.back().weight++;
+    }
+
+    size_t arenaSize = keyed.size() * sizeof(Record*) + keyList.size() * sizeof(TreeNode) + 64;
+    OptimalSearchTree* tree = new OptimalSearchTree(arenaSize);
+
+    Record** records = static_cast<Record**>(tree->arena.allocate(keyed.size() * sizeof(Record*), alignof(Record*)));
+    for (size_t i = 0; i < keyed.size(); ++i) {
+        records[i] = keyed[i].record;
+    }
+
+    tree->root = buildTreeA1Recursive(tree, keyList, records, 0, keyList.size() - 1);
     tree->totalKeys = keyList.size();
     tree->totalRecords = queue.size;
     tree->keyType = "количество страниц (дерево оптимального поиска, алгоритм A1)";
@@ -114,21 +113,21 @@ OptimalSearchTree* buildOptimalSearchTreeA1(Queue& queue) {
 }
 
 std::vector<Record*> searchInTreeByPages(OptimalSearchTree* tree, int pages) {
+    INSTR_TIMER("tree.searchByPages");
     std::vector<Record*> results;
     
     if (tree == nullptr || tree->root == nullptr) {
         return results;
     }
     
-    std::string search_key = std::to_string(pages);
     std::function<void(TreeNode*)> searchRecursive = [&](TreeNode* node) {
         if (node == nullptr) return;
         
-        if (node->key == search_key) {
-            results.insert(results.end(), node->records.begin(), node->records.end());
+        if (node->key == pages) {
+            results.insert(results.end(), node->records, node->records + node->recordCount);
         }
         
-        int node_pages = std::stoi(node->key);
+        int node_pages = node->key;
         if (pages < node_pages) {
             searchRecursive(node->left);
         } else if (pages > node_pages) {
@@ -143,58 +142,74 @@ std::vector<Record*> searchInTreeByPages(OptimalSearchTree* tree, int pages) {
     return results;
 }
 
+uint64_t pagesQueryKey(int pages) {
+    return uint64_t(static_cast<uint32_t>(pages) ^ 0x80000000u) << 32;
+}
+
+std::vector<uint64_t> sortPagesQueries(const std::vector<int>& pages) {
+    std::vector<uint64_t> queries(pages.size());
+    for (size_t i = 0; i < pages.size(); ++i) queries[i] = pagesQueryKey(pages[i]) | i;
+    std::sort(queries.begin(), queries.end());
+    return queries;
+}
+
+void searchTreeRange(const TreeNode* node, const std::vector<uint64_t>& queries, size_t low, size_t high,
+                     std::vector<TreeLookup>& results) {
+    while (node != nullptr && low < high) {
+        uint64_t key = pagesQueryKey(node->key);
+        auto first = queries.begin();
+        size_t split = std::lower_bound(first + low, first + high, key) - first;
+        size_t equal = std::lower_bound(first + split, first + high, key | 0xFFFFFFFFu) - first;
+        for (size_t i = split; i < equal; ++i) {
+            results[static_cast<uint32_t>(queries[i])] = TreeLookup{node->records, node->recordCount};
+        }
+
+        searchTreeRange(node->left, queries, low, split, results);
+        low = equal;
+        node = node->right;
+    }
+}
+
+std::vector<TreeLookup> searchInTreeByPagesBatch(const OptimalSearchTree* tree, const std::vector<int>& pages) {
+    INSTR_TIMER("tree.searchByPagesBatch");
+    std::vector<TreeLookup> results(pages.size(), TreeLookup{nullptr, 0});
+    if (tree == nullptr || tree->root == nullptr || pages.empty()) return results;
+
+    std::vector<uint64_t> queries = sortPagesQueries(pages);
+    searchTreeRange(tree->root, queries, 0, queries.size(), results);
+    return results;
+}
+
 void displayTreeSearchResults(const std::vector<Record*>& results, int search_pages) {
-    system("clear");
-    
+    std::string screen;
+    beginScreen(screen);
+    appendBorder(screen, BORDER_TOP);
+    appendCenteredBoxLine(screen, "ПОИСК В ДЕРЕВЕ (страниц: " + std::to_string(search_pages) + ")");
+    appendBorder(screen, BORDER_MIDDLE);
+
     if (results.empty()) {
-        std::cout << "╔═══════════════════════════════════════════════════════════════════════════╗\n";
-        std::cout << "║                    ПОИСК В ДЕРЕВЕ (страниц: " << std::setw(4) << search_pages << ")                   ║\n";
-        std::cout << "╠═══════════════════════════════════════════════════════════════════════════╣\n";
-        std::cout << "║                                                                            ║\n";
-        std::cout << "║                    Записей с " << std::setw(4) << search_pages << " страницами не найдено.              ║\n";
-        std::cout << "║                                                                            ║\n";
-        std::cout << "╚═══════════════════════════════════════════════════════════════════════════╝\n";
-        std::cout << "\nНажмите Enter...";
+        appendBoxLine(screen, "");
+        appendCenteredBoxLine(screen, "Записей с " + std::to_string(search_pages) + " страницами не найдено.");
+        appendBoxLine(screen, "");
+        appendBorder(screen, BORDER_BOTTOM);
+        screen += "\nНажмите Enter...";
+        flushScreen(screen);
         std::cin.get();
         return;
     }
-    
-    system("clear");
-    
-    std::cout << "╔═══════════════════════════════════════════════════════════════════════════╗\n";
-    std::cout << "║                    ПОИСК В ДЕРЕВЕ (страниц: " << std::setw(4) << search_pages << ")                   ║\n";
-    std::cout << "╠═══════════════════════════════════════════════════════════════════════════╣\n";
-    std::cout << "║ Автор         Заглавие                     Издательство     Год   Стр   ║\n";
-    std::cout << "╠═══════════════════════════════════════════════════════════════════════════╣\n";
-    
-    for (int i = 0; i < results.size(); i++) {
-        Record* rec = results[i];
-        
-        std::string author = convertToUTF8(rec->author, 12);
-        std::string title = convertToUTF8(rec->title, 32);
-        std::string publisher = convertToUTF8(rec->publisher, 16);
-        
-        size_t author_end = author.find_last_not_of(' ');
-        if (author_end != std::string::npos) author = author.substr(0, author_end + 1);
-        
-        size_t title_end = title.find_last_not_of(' ');
-        if (title_end != std::string::npos) title = title.substr(0, title_end + 1);
-        
-        size_t publisher_end = publisher.find_last_not_of(' ');
-        if (publisher_end != std::string::npos) publisher = publisher.substr(0, publisher_end + 1);
-        
-        std::cout << "║ " << std::left << std::setw(12) << author << " "
-                  << std::setw(32) << title << " "
-                  << std::setw(16) << publisher << " "
-                  << std::setw(4) << rec->year << " "
-                  << std::setw(4) << rec->pages << " ║\n";
+
+    appendBoxLine(screen, "Автор        Заглавие                         Издательство     Год  Стр");
+    appendBorder(screen, BORDER_MIDDLE);
+
+    for (size_t i = 0; i < results.size(); i++) {
+        appendRecordRow(screen, results[i]);
     }
-    
-    std::cout << "╠═══════════════════════════════════════════════════════════════════════════╣\n";
-    std::cout << "║ Найдено записей: " << std::setw(58) << std::left << results.size() << "║\n";
-    std::cout << "╚═══════════════════════════════════════════════════════════════════════════╝\n";
-    
-    std::cout << "\nНажмите Enter для возврата...";
+
+    appendBorder(screen, BORDER_MIDDLE);
+    appendBoxLine(screen, "Найдено записей: " + std::to_string(results.size()));
+    appendBorder(screen, BORDER_BOTTOM);
+    screen += "\nНажмите Enter для возврата...";
+    flushScreen(screen);
     std::cin.get();
 }
 
@@ -203,8 +218,8 @@ void inorderTraversalWithRecords(TreeNode* root, std::vector<Record*>& result) {
     
     inorderTraversalWithRecords(root->left, result);
     
-    for (Record* rec : root->records) {
-        result.push_back(rec);
+    for (int i = 0; i < root->recordCount; i++) {
+        result.push_back(root->records[i]);
     }
     
     inorderTraversalWithRecords(root->right, result);
@@ -223,50 +238,30 @@ void displayTreeTraversals(OptimalSearchTree* tree) {
     int total_pages = (inorder_records.size() + per_page - 1) / per_page;
     int current_page = 0;
     
+    std::string screen;
     do {
-        system("clear");
-        std::cout << "╔═══════════════════════════════════════════════════════════════════════════╗\n";
-        std::cout << "║                     ОБХОД ДЕРЕВА A1 (Inorder Л-К-П)                      ║\n";
-        std::cout << "╠═══════════════════════════════════════════════════════════════════════════╣\n";
-        std::cout << "║ Автор         Заглавие                     Издательство     Год   Стр   ║\n";
-        std::cout << "╠═══════════════════════════════════════════════════════════════════════════╣\n";
+        beginScreen(screen);
+        appendBorder(screen, BORDER_TOP);
+        appendCenteredBoxLine(screen, "ОБХОД ДЕРЕВА A1 (Inorder Л-К-П)");
+        appendBorder(screen, BORDER_MIDDLE);
+        appendBoxLine(screen, "Автор        Заглавие                         Издательство     Год  Стр");
+        appendBorder(screen, BORDER_MIDDLE);
         
         int start = current_page * per_page;
         int end = std::min(start + per_page, (int)inorder_records.size());
         
         for (int i = start; i < end; i++) {
-            Record* rec = inorder_records[i];
-            
-            std::string author = convertToUTF8(rec->author, 12);
-            std::string title = convertToUTF8(rec->title, 32);
-            std::string publisher = convertToUTF8(rec->publisher, 16);
-            
-            size_t author_end = author.find_last_not_of(' ');
-            if (author_end != std::string::npos) author = author.substr(0, author_end + 1);
-            
-            size_t title_end = title.find_last_not_of(' ');
-            if (title_end != std::string::npos) title = title.substr(0, title_end + 1);
-            
-            size_t publisher_end = publisher.find_last_not_of(' ');
-            if (publisher_end != std::string::npos) publisher = publisher.substr(0, publisher_end + 1);
-            
-            std::cout << "║ " << std::left << std::setw(12) << author << " "
-                      << std::setw(32) << title << " "
-                      << std::setw(16) << publisher << " "
-                      << std::setw(4) << rec->year << " "
-                      << std::setw(4) << rec->pages << " ║\n";
-        }
-        
-        for (int i = end - start; i < per_page; i++) {
-            std::cout << "║                                                                             ║\n";
+            appendRecordRow(screen, inorder_records[i]);
         }
         
-        std::cout << "╠═══════════════════════════════════════════════════════════════════════════╣\n";
-        std::cout << "║ Страница " << std::setw(2) << (current_page + 1) << "/" << std::setw(2) << total_pages 
-                  << " | N - след. | P - пред. | B - назад | T - поиск в дереве | Всего: " 
-                  << std::setw(4) << inorder_records.size() << " ║\n";
-        std::cout << "╚═══════════════════════════════════════════════════════════════════════════╝\n";
-        std::cout << "Выбор: ";
+        appendEmptyRows(screen, per_page - (end - start));
+        appendBorder(screen, BORDER_MIDDLE);
+        appendBoxLine(screen, "Страница " + std::to_string(current_page + 1) + "/" + std::to_string(total_pages) +
+                              " | N - след. | P - пред. | B - назад | T - поиск в дереве | Всего: " +
+                              std::to_string(inorder_records.size()));
+        appendBorder(screen, BORDER_BOTTOM);
+        screen += "Выбор: ";
+        flushScreen(screen);
         
         std::string input;
         std::getline(std::cin, input);
@@ -274,13 +269,20 @@ void displayTreeTraversals(OptimalSearchTree* tree) {
         std::transform(input.begin(), input.end(), input.begin(), ::tolower);
         
         if (input == "t") {
-            int search_pages;
-            std::cout << "\nВведите количество страниц для поиска: ";
-            std::cin >> search_pages;
-            std::cin.ignore();
-            
-            std::vector<Record*> results = searchInTreeByPages(tree, search_pages);
-            displayTreeSearchResults(results, search_pages);
+            std::string line;
+            std::cout << "\nВведите количество страниц для поиска (можно несколько через пробел): ";
+            std::getline(std::cin, line);
+
+            std::istringstream values(line);
+            std::vector<int> search_pages;
+            int pages;
+            while (values >> pages) search_pages.push_back(pages);
+
+            std::vector<TreeLookup> results = searchInTreeByPagesBatch(tree, search_pages);
+            for (size_t i = 0; i < results.size(); ++i) {
+                displayTreeSearchResults(std::vector<Record*>(results[i].records, results[i].records + results[i].count),
+                                         search_pages[i]);
+            }
             
             current_page = 0;
             continue;
@@ -307,7 +309,7 @@ void printTreeHorizontal(TreeNode* root, int depth, const std::string& indent, b
     }
     
     std::cout << root->key << " стр. [w:" << root->weight 
-              << ", n:" << root->records.size() 
+              << ", n:" << root->recordCount 
               << "]";
     
     std::cout << "\n";
@@ -347,15 +349,6 @@ void printOptimalTree(const OptimalSearchTree* tree) {
     printTreeHorizontal(tree->root, 0, "", true);
 }
 
-void clearTreeNodes(TreeNode* root) {
-    if (root == nullptr) return;
-    clearTreeNodes(root->left);
-    clearTreeNodes(root->right);
-    delete root;
-}
-
 void clearOptimalTree(OptimalSearchTree* tree) {
-    if (tree == nullptr) return;
-    clearTreeNodes(tree->root);
     delete tree;
 }
\ No newline at end of file
@@ -0,0 +1,205 @@
+#include "treefile.h"
+#include "instrument.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+int32_t flattenTreeNode(const TreeNode* node, const Record* base,
+                        std::vector<TreeFileNode>& nodes, std::vector<uint32_t>& ordinals) {
+    if (node == nullptr) return -1;
+
+    int32_t index = nodes.size();
+    nodes.push_back({node->key, node->weight, static_cast<uint32_t>(ordinals.size()),
+                     static_cast<uint32_t>(node->recordCount), -1, -1});
+    for (int i = 0; i < node->recordCount; ++i) {
+        ordinals.push_back(node->records[i] - base);
+    }
+
+    int32_t left = flattenTreeNode(node->left, base, nodes, ordinals);
+    int32_t right = flattenTreeNode(node->right, base, nodes, ordinals);
+    nodes[index].left = left;
+    nodes[index].right = right;
+    return index;
+}
+
+uint64_t databaseFingerprint(const std::vector<Record>& db) {
+    INSTR_TIMER("treefile.fingerprint");
+    const char* bytes = reinterpret_cast<const char*>(db.data());
+    size_t size = db.size() * sizeof(Record);
+    uint64_t hash = 0xCBF29CE484222325ull ^ size;
+    for (size_t i = 0; i < size; i += sizeof(uint64_t)) {
+        uint64_t word = 0;
+        memcpy(&word, bytes + i, std::min(sizeof(word), size - i));
+        hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+        hash ^= hash >> 32;
+    }
+    return hash ^ db.size();
+}
+
+bool saveOptimalTree(const OptimalSearchTree* tree, const std::vector<Record>& db, const std::string& filename) {
+    INSTR_TIMER("treefile.save");
+    std::vector<TreeFileNode> nodes;
+    std::vector<uint32_t> ordinals;
+    if (tree != nullptr) {
+        nodes.reserve(tree->totalKeys);
+        ordinals.reserve(tree->totalRecords);
+        flattenTreeNode(tree->root, db.data(), nodes, ordinals);
+    }
+    for (uint32_t ordinal : ordinals) {
+        if (ordinal >= db.size()) return false;
+    }
+
+    TreeFileHeader header{};
+    memcpy(header.magic, TREE_FILE_MAGIC, sizeof(header.magic));
+    header.version = TREE_FILE_VERSION;
+    header.nodeCount = nodes.size();
+    header.recordCount = ordinals.size();
+    header.dbRecords = db.size();
+    header.nodesOffset = sizeof(TreeFileHeader);
+    header.recordsOffset = header.nodesOffset + nodes.size() * sizeof(TreeFileNode);
+    header.dbFingerprint = databaseFingerprint(db);
+
+    std::string tempname = filename + ".tmp";
+    std::ofstream file(tempname, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(nodes.data()), nodes.size() * sizeof(TreeFileNode));
+    file.write(reinterpret_cast<const char*>(ordinals.data()), ordinals.size() * sizeof(uint32_t));
+    file.close();
+    if (!file || rename(tempname.c_str(), filename.c_str()) != 0) {
+        remove(tempname.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool validMappedTree(const MappedTree& tree, const std::vector<Record>& db) {
+    const TreeFileHeader& header = *tree.header;
+    if (memcmp(header.magic, TREE_FILE_MAGIC, sizeof(header.magic)) != 0 || header.version != TREE_FILE_VERSION) {
+        return false;
+    }
+    if (header.dbRecords != db.size() || header.dbFingerprint != databaseFingerprint(db)) return false;
+    if (header.nodesOffset != sizeof(TreeFileHeader) ||
+        header.recordsOffset != header.nodesOffset + uint64_t(header.nodeCount) * sizeof(TreeFileNode) ||
+        header.recordsOffset + uint64_t(header.recordCount) * sizeof(uint32_t) != tree.size) {
+        return false;
+    }
+    for (uint32_t i = 0; i < header.nodeCount; ++i) {
+        const TreeFileNode& node = tree.nodes[i];
+        if (node.left >= int32_t(header.nodeCount) || node.right >= int32_t(header.nodeCount) ||
+            (node.left >= 0 && uint32_t(node.left) <= i) || (node.right >= 0 && uint32_t(node.right) <= i) ||
+            uint64_t(node.firstRecord) + node.recordCount > header.recordCount) {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < header.recordCount; ++i) {
+        if (tree.records[i] >= header.dbRecords) return false;
+    }
+    return true;
+}
+
+bool openMappedTree(MappedTree& tree, const std::string& filename, const std::vector<Record>& db) {
+    INSTR_TIMER("treefile.open");
+    tree = MappedTree{nullptr, 0, 0, 0, 0, nullptr, nullptr, nullptr};
+
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size < static_cast<off_t>(sizeof(TreeFileHeader))) {
+        close(fd);
+        return false;
+    }
+    void* base = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return false;
+
+    const char* bytes = static_cast<const char*>(base);
+    tree.base = base;
+    tree.size = st.st_size;
+    tree.device = st.st_dev;
+    tree.inode = st.st_ino;
+    tree.modified = int64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    tree.header = reinterpret_cast<const TreeFileHeader*>(bytes);
+    tree.nodes = reinterpret_cast<const TreeFileNode*>(bytes + sizeof(TreeFileHeader));
+    tree.records = reinterpret_cast<const uint32_t*>(bytes + sizeof(TreeFileHeader) +
+                                                     tree.header->nodeCount * sizeof(TreeFileNode));
+    if (!validMappedTree(tree, db)) {
+        closeMappedTree(tree);
+        return false;
+    }
+    return true;
+}
+
+bool mappedTreeCurrent(const MappedTree& tree, const std::string& filename) {
+    struct stat st;
+    if (tree.header == nullptr || stat(filename.c_str(), &st) < 0) return false;
+    return uint64_t(st.st_dev) == tree.device && uint64_t(st.st_ino) == tree.inode &&
+           size_t(st.st_size) == tree.size &&
+           int64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec == tree.modified;
+}
+
+void closeMappedTree(MappedTree& tree) {
+    if (tree.base != nullptr) munmap(tree.base, tree.size);
+    tree = MappedTree{nullptr, 0, 0, 0, 0, nullptr, nullptr, nullptr};
+}
+
+std::vector<Record*> searchMappedTreeByPages(const MappedTree& tree, const std::vector<Record>& db, int pages) {
+    INSTR_TIMER("treefile.searchByPages");
+    std::vector<Record*> results;
+    if (tree.header == nullptr || tree.header->dbRecords != db.size()) return results;
+
+    int32_t index = tree.header->nodeCount > 0 ? 0 : -1;
+    while (index >= 0) {
+        const TreeFileNode& node = tree.nodes[index];
+        if (pages < node.key) {
+            index = node.left;
+        } else if (pages > node.key) {
+            index = node.right;
+        } else {
+            for (uint32_t i = 0; i < node.recordCount; ++i) {
+                results.push_back(const_cast<Record*>(&db[tree.records[node.firstRecord + i]]));
+            }
+            break;
+        }
+    }
+    return results;
+}
+
+void searchMappedRange(const MappedTree& tree, int32_t index, const std::vector<uint64_t>& queries, size_t low,
+                       size_t high, std::vector<MappedTreeLookup>& results) {
+    while (index >= 0 && low < high) {
+        const TreeFileNode& node = tree.nodes[index];
+        uint64_t key = pagesQueryKey(node.key);
+        auto first = queries.begin();
+        size_t split = std::lower_bound(first + low, first + high, key) - first;
+        size_t equal = std::lower_bound(first + split, first + high, key | 0xFFFFFFFFu) - first;
+        for (size_t i = split; i < equal; ++i) {
+            results[static_cast<uint32_t>(queries[i])] = MappedTreeLookup{tree.records + node.firstRecord, node.recordCount};
+        }
+
+        searchMappedRange(tree, node.left, queries, low, split, results);
+        low = equal;
+        index = node.right;
+    }
+}
+
+std::vector<MappedTreeLookup> searchMappedTreeByPagesBatch(const MappedTree& tree, const std::vector<int>& pages) {
+    INSTR_TIMER("treefile.searchByPagesBatch");
+    std::vector<MappedTreeLookup> results(pages.size(), MappedTreeLookup{nullptr, 0});
+    if (tree.header == nullptr || tree.header->nodeCount == 0) return results;
+
+    std::vector<uint64_t> queries = sortPagesQueries(pages);
+    searchMappedRange(tree, 0, queries, 0, queries.size(), results);
+    return results;
+}
+
+std::vector<Record*> mappedLookupRecords(const std::vector<Record>& db, const MappedTreeLookup& lookup) {
+    std::vector<Record*> records;
+    records.reserve(lookup.count);
+    for (uint32_t i = 0; i < lookup.count; ++i) records.push_back(const_cast<Record*>(&db[lookup.ordinals[i]]));
+    return records;
+}
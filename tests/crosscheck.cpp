@@ -0,0 +1,487 @@
+#include "database.h"
+#include "sort.h"
+#include "search.h"
+#include "queue.h"
+#include "tree.h"
+#include "generator.h"
+#include "columns.h"
+#include "simdscan.h"
+#include "bitmap.h"
+#include "treefile.h"
+#include "shards.h"
+#include "textsearch.h"
+#include "transcode.h"
+#include "aggregate.h"
+#include "indexes.h"
+#include "batch.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+
+struct CheckContext {
+    std::string tmpDir = "/tmp";
+    int failures = 0;
+};
+
+struct Check {
+    const char* name;
+    void (*run)(CheckContext&);
+};
+
+void expect(CheckContext& ctx, bool ok, const std::string& what) {
+    if (ok) return;
+    ctx.failures++;
+    std::cerr << "  расхождение: " << what << std::endl;
+}
+
+std::vector<Record> generatedBase(long long count, unsigned seed, GeneratorOrder order) {
+    GeneratorOptions opts;
+    opts.count = count;
+    opts.seed = seed;
+    opts.order = order;
+    return generateRecords(opts);
+}
+
+std::vector<Record*> recordPointers(std::vector<Record>& db) {
+    std::vector<Record*> indices;
+    indices.reserve(db.size());
+    for (Record& rec : db) indices.push_back(&rec);
+    return indices;
+}
+
+std::vector<uint32_t> ordinals(const std::vector<Record>& db, const std::vector<Record*>& records) {
+    std::vector<uint32_t> result;
+    result.reserve(records.size());
+    for (const Record* rec : records) result.push_back(static_cast<uint32_t>(rec - db.data()));
+    return result;
+}
+
+std::vector<uint32_t> sortedOrdinals(const std::vector<Record>& db, const std::vector<Record*>& records) {
+    std::vector<uint32_t> result = ordinals(db, records);
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::vector<uint32_t> linearRows(size_t rows, const std::function<bool(size_t)>& match) {
+    std::vector<uint32_t> result;
+    for (size_t i = 0; i < rows; ++i) {
+        if (match(i)) result.push_back(static_cast<uint32_t>(i));
+    }
+    return result;
+}
+
+std::vector<uint32_t> bitmapRows(const std::vector<uint64_t>& bitmap, size_t rows) {
+    std::vector<uint32_t> result;
+    bitmapToRows(bitmap, rows, result);
+    return result;
+}
+
+bool sortedBySurname(const std::vector<Record*>& indices, bool stable) {
+    for (size_t i = 1; i < indices.size(); ++i) {
+        int cmp = SurnameIndexKey::compare(*indices[i - 1], *indices[i]);
+        if (cmp > 0 || (stable && cmp == 0 && indices[i - 1] > indices[i])) return false;
+    }
+    return true;
+}
+
+bool sameSurnames(const std::vector<Record*>& a, const std::vector<Record*>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (SurnameIndexKey::compare(*a[i], *b[i]) != 0) return false;
+    }
+    return true;
+}
+
+void checkSort(CheckContext& ctx) {
+    const GeneratorOrder orders[] = {ORDER_RANDOM, ORDER_PRESORTED, ORDER_REVERSED, ORDER_NEARLY_SORTED,
+                                     ORDER_EQUAL_SURNAMES};
+    for (GeneratorOrder order : orders) {
+        std::vector<Record> db = generatedBase(20000, 7 + order, order);
+        std::vector<Record*> hoare = recordPointers(db);
+        std::vector<Record*> adaptive = hoare;
+        std::vector<uint32_t> all = sortedOrdinals(db, hoare);
+        quickSortHoare(hoare, 0, static_cast<int>(hoare.size()) - 1);
+        sortSurnameIndex(adaptive, SORT_METHOD_ADAPTIVE);
+
+        std::string name = "порядок генератора " + std::to_string(order);
+        expect(ctx, sortedOrdinals(db, hoare) == all, name + ": quickSortHoare потерял записи");
+        expect(ctx, sortedOrdinals(db, adaptive) == all, name + ": timsort потерял записи");
+        expect(ctx, sortedBySurname(hoare, false), name + ": quickSortHoare не упорядочил фамилии");
+        expect(ctx, sortedBySurname(adaptive, true), name + ": timsort не упорядочил фамилии устойчиво");
+        expect(ctx, sameSurnames(hoare, adaptive), name + ": порядок фамилий timsort и quickSortHoare");
+    }
+}
+
+void checkScan(CheckContext& ctx) {
+    std::vector<Record> db = generatedBase(30011, 11, ORDER_RANDOM);
+    size_t rows = db.size();
+    std::vector<int16_t> pages(rows + SCAN_PADDING, 0);
+    std::vector<char> titles(rows * TITLE_WIDTH + SCAN_PADDING, '\0');
+    for (size_t i = 0; i < rows; ++i) {
+        pages[i] = db[i].pages;
+        memcpy(&titles[i * TITLE_WIDTH], db[i].title, TITLE_WIDTH);
+    }
+
+    std::vector<std::pair<int, int>> ranges = {{100, 200}, {0, 0}, {-5, 40000}, {db[3].pages, db[3].pages},
+                                               {300, 250}};
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < 5; ++i) keys.push_back(std::string(db[i * 4001].title, 1 + i * 3));
+    keys.push_back(std::string(db[17].title, TITLE_WIDTH));
+    std::string needle(db[29].title + 2, 4);
+
+    ScanIsa saved = activeScanIsa();
+    std::vector<std::vector<uint32_t>> scalar;
+    std::vector<uint64_t> bitmap;
+    for (int isa = SCAN_SCALAR; isa <= detectScanIsa(); ++isa) {
+        setScanIsa(static_cast<ScanIsa>(isa));
+        std::string name = std::string("набор команд ") + scanIsaName(activeScanIsa());
+        std::vector<std::vector<uint32_t>> results;
+
+        for (const auto& range : ranges) {
+            filterRangeBitmap(pages.data(), rows, range.first, range.second, bitmap);
+            results.push_back(bitmapRows(bitmap, rows));
+            expect(ctx, bitmapCount(bitmap) == results.back().size(), name + ": число битов диапазона");
+            expect(ctx, results.back() == linearRows(rows, [&](size_t i) {
+                return db[i].pages >= range.first && db[i].pages <= range.second;
+            }), name + ": диапазон страниц " + std::to_string(range.first) + "-" + std::to_string(range.second));
+        }
+        for (const std::string& key : keys) {
+            filterTextBitmap(titles.data(), TITLE_WIDTH, rows, key.data(), key.size(), true, bitmap);
+            results.push_back(bitmapRows(bitmap, rows));
+            expect(ctx, results.back() == linearRows(rows, [&](size_t i) {
+                return memcmp(db[i].title, key.data(), key.size()) == 0;
+            }), name + ": префикс названия длиной " + std::to_string(key.size()));
+            filterTextBitmap(titles.data(), TITLE_WIDTH, rows, key.data(), key.size(), false, bitmap);
+            results.push_back(bitmapRows(bitmap, rows));
+        }
+        filterSubstringBitmap(titles.data(), TITLE_WIDTH, rows, needle.data(), needle.size(), bitmap);
+        results.push_back(bitmapRows(bitmap, rows));
+        expect(ctx, results.back() == linearRows(rows, [&](size_t i) {
+            const char* end = db[i].title + TITLE_WIDTH;
+            return std::search(static_cast<const char*>(db[i].title), end, needle.begin(), needle.end()) != end;
+        }), name + ": подстрока названия");
+
+        if (isa == SCAN_SCALAR) scalar = results;
+        expect(ctx, results == scalar, name + ": результаты отличаются от скалярного просмотра");
+    }
+    setScanIsa(saved);
+}
+
+void checkTreeFile(CheckContext& ctx) {
+    std::vector<Record> db = generatedBase(20000, 21, ORDER_RANDOM);
+    std::vector<Record*> sorted = recordPointers(db);
+    sortSurnameIndex(sorted, SORT_METHOD_HOARE);
+    std::string filename = ctx.tmpDir + "/coursework_crosscheck_treefile.a1";
+
+    std::set<std::string> prefixes;
+    for (size_t i = 0; i < sorted.size(); i += 2477) prefixes.insert(getSurnamePrefix(*sorted[i]));
+    for (const std::string& prefix : prefixes) {
+        Queue queue = binarySearchWithIndexing(sorted, prefix);
+        std::vector<Record*> found;
+        std::vector<int> pages = {-1, 0, 32767};
+        for (QueueNode* node = queue.front; node != nullptr; node = node->next) {
+            found.push_back(node->data);
+            pages.push_back(node->data->pages);
+            pages.push_back(node->data->pages + 1);
+        }
+        OptimalSearchTree* tree = buildOptimalSearchTreeA1(queue);
+        MappedTree mapped;
+        bool opened = saveOptimalTree(tree, db, filename) && openMappedTree(mapped, filename, db);
+        expect(ctx, opened, "префикс " + prefix + ": файл дерева не сохранён или не открыт");
+        if (opened) {
+            std::vector<TreeLookup> inMemory = searchInTreeByPagesBatch(tree, pages);
+            std::vector<MappedTreeLookup> fromFile = searchMappedTreeByPagesBatch(mapped, pages);
+            for (size_t i = 0; i < pages.size(); ++i) {
+                int p = pages[i];
+                std::vector<Record*> linear;
+                for (Record* rec : found) {
+                    if (rec->pages == p) linear.push_back(rec);
+                }
+                std::vector<Record*> batchMemory(inMemory[i].records, inMemory[i].records + inMemory[i].count);
+                std::string name = "префикс " + prefix + ", страниц " + std::to_string(p);
+                expect(ctx, ordinals(db, searchInTreeByPages(tree, p)) ==
+                            ordinals(db, searchMappedTreeByPages(mapped, db, p)),
+                       name + ": дерево в памяти и файл дерева");
+                expect(ctx, ordinals(db, batchMemory) == ordinals(db, mappedLookupRecords(db, fromFile[i])),
+                       name + ": пакетный поиск в памяти и в файле");
+                expect(ctx, sortedOrdinals(db, batchMemory) == sortedOrdinals(db, linear),
+                       name + ": дерево и перебор очереди");
+            }
+            closeMappedTree(mapped);
+        }
+        clearOptimalTree(tree);
+        clearQueue(queue);
+    }
+    std::remove(filename.c_str());
+}
+
+void checkBitmap(CheckContext& ctx) {
+    std::vector<Record> db = generatedBase(150000, 31, ORDER_RANDOM);
+    ColumnStore store;
+    initColumnStore(store, db);
+    const ColumnStore& columns = columnStore(store);
+    size_t rows = db.size();
+    int year = db[0].year;
+    std::string publisher = recordFieldText(db[0].publisher, PUBLISHER_WIDTH);
+
+    std::vector<uint64_t> words;
+    std::vector<uint32_t> rowList;
+    std::vector<RecordBitmap> bitmaps;
+    std::vector<std::vector<uint32_t>> linear;
+
+    scanRangeBitmap(columns, FIELD_YEAR, year - 10, year + 10, words);
+    bitmaps.push_back(recordBitmapFromWords(words, rows));
+    linear.push_back(linearRows(rows, [&](size_t i) { return db[i].year >= year - 10 && db[i].year <= year + 10; }));
+
+    scanRange(columns, FIELD_PAGES, 100, 103, rowList);
+    bitmaps.push_back(recordBitmapFromRows(rowList));
+    linear.push_back(linearRows(rows, [&](size_t i) { return db[i].pages >= 100 && db[i].pages <= 103; }));
+
+    scanTextBitmap(columns, FIELD_PUBLISHER, publisher, false, words);
+    bitmaps.push_back(recordBitmapFromWords(words, rows));
+    linear.push_back(linearRows(rows, [&](size_t i) {
+        return recordFieldText(db[i].publisher, PUBLISHER_WIDTH) == publisher;
+    }));
+
+    std::vector<Record*> everyThird;
+    for (size_t i = 0; i < rows; i += 3) everyThird.push_back(&db[i]);
+    bitmaps.push_back(recordBitmapFromRecords(db, everyThird));
+    linear.push_back(linearRows(rows, [](size_t i) { return i % 3 == 0; }));
+
+    for (size_t a = 0; a < bitmaps.size(); ++a) {
+        recordBitmapRows(bitmaps[a], rowList);
+        expect(ctx, rowList == linear[a], "условие " + std::to_string(a) + ": набор и перебор");
+        expect(ctx, recordBitmapCardinality(bitmaps[a]) == linear[a].size(),
+               "условие " + std::to_string(a) + ": мощность набора");
+        for (size_t b = 0; b < bitmaps.size(); ++b) {
+            const BitmapOp ops[] = {BITMAP_AND, BITMAP_OR, BITMAP_ANDNOT};
+            for (BitmapOp op : ops) {
+                std::vector<uint32_t> expected;
+                if (op == BITMAP_AND) {
+                    std::set_intersection(linear[a].begin(), linear[a].end(), linear[b].begin(), linear[b].end(),
+                                          std::back_inserter(expected));
+                } else if (op == BITMAP_OR) {
+                    std::set_union(linear[a].begin(), linear[a].end(), linear[b].begin(), linear[b].end(),
+                                   std::back_inserter(expected));
+                } else {
+                    std::set_difference(linear[a].begin(), linear[a].end(), linear[b].begin(), linear[b].end(),
+                                        std::back_inserter(expected));
+                }
+                RecordBitmap combined = combineRecordBitmaps(bitmaps[a], bitmaps[b], op);
+                recordBitmapRows(combined, rowList);
+                std::string name = "условия " + std::to_string(a) + " и " + std::to_string(b) +
+                                   ", операция " + std::to_string(op);
+                expect(ctx, rowList == expected, name + ": набор и перебор");
+                expect(ctx, recordBitmapCardinality(combined) == expected.size(), name + ": мощность набора");
+            }
+        }
+    }
+
+    std::vector<Record*> sorted = recordPointers(db);
+    sortSurnameIndex(sorted, SORT_METHOD_HOARE);
+    SecondaryIndexes indexes;
+    TextSearchIndex textSearch;
+    BatchShared shared;
+    BatchContext batch;
+    initSecondaryIndexes(indexes, db);
+    initTextSearchIndex(textSearch, db, sorted);
+    initBatchShared(shared, 1);
+    initBatchContext(batch, db, sorted, indexes, store, textSearch, shared, {}, BATCH_TSV);
+
+    std::string query = "query year " + std::to_string(year - 10) + " " + std::to_string(year + 10) +
+                        " || pages 100 103 &! publisher " + publisher;
+    size_t expected = 0;
+    for (size_t i = 0; i < rows; ++i) {
+        bool match = (db[i].year >= year - 10 && db[i].year <= year + 10) || (db[i].pages >= 100 && db[i].pages <= 103);
+        if (match && recordFieldText(db[i].publisher, PUBLISHER_WIDTH) != publisher) expected++;
+    }
+    std::string out;
+    executeBatchQuery(batch, query, 1, out);
+    expect(ctx, out.compare(0, out.find('\n'), "1\tcount\t" + std::to_string(expected)) == 0,
+           "команда query и перебор: " + out.substr(0, out.find('\n')));
+
+    clearBatchContext(batch);
+    clearBatchShared(shared);
+}
+
+bool writeRecords(const std::string& filename, const Record* first, size_t count) {
+    std::ofstream out(filename, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(first), count * sizeof(Record));
+    return static_cast<bool>(out);
+}
+
+void checkShards(CheckContext& ctx) {
+    const GeneratorOrder orders[] = {ORDER_RANDOM, ORDER_EQUAL_SURNAMES};
+    for (GeneratorOrder order : orders) {
+        std::vector<Record> base = generatedBase(30000, 41 + order, order);
+        std::string prefix = ctx.tmpDir + "/coursework_crosscheck_shards_";
+        std::string whole = prefix + "all.dat";
+        std::vector<std::string> files = {prefix + "0.dat", prefix + "1.dat", prefix + "2.dat"};
+        size_t bounds[] = {0, 7001, 22001, base.size()};
+        bool written = writeRecords(whole, base.data(), base.size());
+        for (size_t i = 0; i < files.size(); ++i) {
+            written = writeRecords(files[i], base.data() + bounds[i], bounds[i + 1] - bounds[i]) && written;
+        }
+
+        std::string name = "порядок генератора " + std::to_string(order);
+        std::vector<Record> sharded;
+        std::vector<DatabaseShard> shards;
+        bool loaded = written && loadShardedDatabase(files, sharded, shards);
+        std::vector<Record> single = loadDatabase(whole);
+        expect(ctx, loaded && single.size() == base.size(), name + ": файлы частей не записаны или не загружены");
+        if (loaded && sharded.size() == single.size()) {
+            expect(ctx, memcmp(sharded.data(), single.data(), single.size() * sizeof(Record)) == 0,
+                   name + ": записи частей и единого файла");
+            for (SortMethod method : {SORT_METHOD_HOARE, SORT_METHOD_ADAPTIVE}) {
+                std::vector<Record*> merged = recordPointers(sharded);
+                std::vector<Record*> plain = recordPointers(single);
+                sortShardedIndex(merged, shards, method);
+                sortSurnameIndex(plain, method);
+                std::string label = name + (method == SORT_METHOD_ADAPTIVE ? ", adaptive" : ", hoare");
+                expect(ctx, sortedOrdinals(sharded, merged) == sortedOrdinals(single, plain),
+                       label + ": слияние частей потеряло записи");
+                if (method == SORT_METHOD_ADAPTIVE) {
+                    expect(ctx, ordinals(sharded, merged) == ordinals(single, plain),
+                           label + ": порядок слияния частей и единого файла");
+                } else {
+                    expect(ctx, sameSurnames(merged, plain), label + ": фамилии слияния частей и единого файла");
+                }
+            }
+        } else {
+            expect(ctx, false, name + ": размер БД из частей и из единого файла");
+        }
+
+        std::remove(whole.c_str());
+        for (const std::string& file : files) std::remove(file.c_str());
+    }
+}
+
+void checkFuzzy(CheckContext& ctx) {
+    std::vector<Record> db = generatedBase(20000, 51, ORDER_RANDOM);
+    std::vector<Record*> sorted = recordPointers(db);
+    sortSurnameIndex(sorted, SORT_METHOD_HOARE);
+    TextSearchIndex index;
+    initTextSearchIndex(index, db, sorted);
+    buildTextSearchIndex(index);
+
+    std::mt19937 gen(51);
+    std::vector<std::string> queries;
+    for (int i = 0; i < 80; ++i) {
+        std::string word = index.words[gen() % index.words.size()];
+        int edits = gen() % 3;
+        for (int e = 0; e < edits && !word.empty(); ++e) {
+            size_t pos = gen() % word.size();
+            if (gen() % 2) word[pos] = word[(pos + 1) % word.size()];
+            else word.insert(pos, 1, word[pos]);
+        }
+        queries.push_back(cp866ToUTF8(word.data(), word.size()));
+    }
+
+    for (const std::string& query : queries) {
+        std::string folded = foldSearchText(query);
+        for (int k = 0; k <= 2; ++k) {
+            std::set<uint32_t> expected;
+            for (size_t id = 0; id < index.words.size(); ++id) {
+                if (editDistance(folded, index.words[id], k) <= k) {
+                    expected.insert(index.wordRows[id].begin(), index.wordRows[id].end());
+                }
+            }
+            Queue result = fuzzySearch(index, query, k);
+            std::set<uint32_t> found;
+            for (QueueNode* node = result.front; node != nullptr; node = node->next) {
+                found.insert(static_cast<uint32_t>(node->data - db.data()));
+            }
+            clearQueue(result);
+            expect(ctx, found == expected, "слово " + query + ", расстояние " + std::to_string(k) +
+                                           ": индекс и перебор словаря");
+        }
+    }
+}
+
+void checkGroup(CheckContext& ctx) {
+    std::vector<Record> db = generatedBase(200000, 61, ORDER_RANDOM);
+    ColumnStore store;
+    initColumnStore(store, db);
+    const ColumnStore& columns = columnStore(store);
+
+    const GroupKey keys[] = {GROUP_YEAR, GROUP_PUBLISHER, GROUP_AUTHOR};
+    for (GroupKey key : keys) {
+        std::map<std::string, ColumnSummary> expected;
+        for (const Record& rec : db) {
+            std::string value = key == GROUP_YEAR ? std::to_string(rec.year)
+                              : key == GROUP_PUBLISHER ? recordFieldText(rec.publisher, PUBLISHER_WIDTH)
+                              : recordFieldText(rec.author, AUTHOR_WIDTH);
+            auto it = expected.find(value);
+            if (it == expected.end()) {
+                expected[value] = ColumnSummary{1, rec.pages, rec.pages, rec.pages};
+            } else {
+                it->second.count++;
+                it->second.sum += rec.pages;
+                it->second.min = std::min(it->second.min, static_cast<int>(rec.pages));
+                it->second.max = std::max(it->second.max, static_cast<int>(rec.pages));
+            }
+        }
+        for (int threads : {1, 3}) {
+            std::vector<GroupAggregate> groups = aggregateGroups(columns, key, 0, 0, threads);
+            std::map<std::string, ColumnSummary> found;
+            for (const GroupAggregate& group : groups) found[group.value] = group.pages;
+            bool same = found.size() == expected.size();
+            for (auto it = expected.begin(); same && it != expected.end(); ++it) {
+                auto other = found.find(it->first);
+                same = other != found.end() && other->second.count == it->second.count &&
+                       other->second.sum == it->second.sum && other->second.min == it->second.min &&
+                       other->second.max == it->second.max;
+            }
+            expect(ctx, same, "ключ " + std::to_string(key) + ", потоков " + std::to_string(threads) +
+                              ": группировка и перебор");
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    const Check checks[] = {
+        {"sort", checkSort},
+        {"scan", checkScan},
+        {"treefile", checkTreeFile},
+        {"bitmap", checkBitmap},
+        {"shards", checkShards},
+        {"fuzzy", checkFuzzy},
+        {"group", checkGroup},
+    };
+
+    CheckContext ctx;
+    std::set<std::string> selected;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--tmp" && i + 1 < argc) {
+            ctx.tmpDir = argv[++i];
+            continue;
+        }
+        bool known = false;
+        for (const Check& check : checks) known = known || arg == check.name;
+        if (!known) {
+            std::cerr << "Использование: coursework_crosscheck [--tmp DIR] "
+                         "[sort|scan|treefile|bitmap|shards|fuzzy|group]..." << std::endl;
+            return 2;
+        }
+        selected.insert(arg);
+    }
+
+    int failed = 0;
+    for (const Check& check : checks) {
+        if (!selected.empty() && selected.count(check.name) == 0) continue;
+        int before = ctx.failures;
+        check.run(ctx);
+        int found = ctx.failures - before;
+        std::cout << check.name << ": " << (found == 0 ? "совпадает" : std::to_string(found) + " расхождений")
+                  << std::endl;
+        if (found != 0) failed++;
+    }
+    return failed == 0 ? 0 : 1;
+}
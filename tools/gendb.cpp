@@ -0,0 +1,49 @@
+#include "generator.h"
+
+void printGendbUsage() {
+    std::cerr << "Использование: coursework_gendb --out FILE [--count N] [--seed N]\n"
+                 "                       [--order random|presorted|reversed|nearly|equal]\n"
+                 "                       [--skew S] [--tail F]" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    GeneratorOptions opts;
+    std::string outFile;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            printGendbUsage();
+            return 2;
+        }
+        std::string value = argv[++i];
+        if (arg == "--out") outFile = value;
+        else if (arg == "--count") opts.count = std::stoll(value);
+        else if (arg == "--seed") opts.seed = static_cast<unsigned>(std::stoul(value));
+        else if (arg == "--skew") opts.surnameSkew = std::stod(value);
+        else if (arg == "--tail") opts.unsortedTail = std::stod(value);
+        else if (arg == "--order") {
+            if (!parseGeneratorOrder(value, opts.order)) {
+                std::cerr << "Неизвестный порядок: " << value << std::endl;
+                return 2;
+            }
+        } else {
+            printGendbUsage();
+            return 2;
+        }
+    }
+
+    if (outFile.empty() || opts.count < 0) {
+        printGendbUsage();
+        return 2;
+    }
+
+    if (!writeGeneratedDatabase(outFile, opts)) {
+        std::cerr << "Ошибка записи файла " << outFile << std::endl;
+        return 1;
+    }
+
+    std::cerr << "Записано " << opts.count << " записей (" << opts.count * sizeof(Record)
+              << " байт) в " << outFile << std::endl;
+    return 0;
+}
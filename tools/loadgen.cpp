@@ -0,0 +1,174 @@
+#include "server.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+struct LoadOptions {
+    std::string socketPath = "/tmp/coursework.sock";
+    std::string queriesFile;
+    int clients = 8;
+    int requests = 1000;
+    unsigned seed = 42;
+};
+
+struct ClientResult {
+    std::vector<double> latencies;
+    long long errors = 0;
+};
+
+void printLoadgenUsage() {
+    std::cerr << "Использование: coursework_loadgen --queries FILE [--socket PATH] [--clients N]\n"
+                 "                         [--requests N] [--seed N]" << std::endl;
+}
+
+bool parseNumberArg(const std::string& value, long low, long high, long& result) {
+    char* end;
+    errno = 0;
+    result = std::strtol(value.c_str(), &end, 10);
+    return !value.empty() && *end == '\0' && errno != ERANGE && result >= low && result <= high;
+}
+
+int connectSocket(const std::string& path) {
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) return -1;
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void runClient(const LoadOptions& opts, const std::vector<std::string>& queries, int index, ClientResult& result) {
+    int fd = connectSocket(opts.socketPath);
+    if (fd < 0) {
+        result.errors = opts.requests;
+        return;
+    }
+
+    std::mt19937 gen(opts.seed + index);
+    std::uniform_int_distribution<size_t> pick(0, queries.size() - 1);
+    std::string buffer;
+    std::string line;
+    result.latencies.reserve(opts.requests);
+
+    for (int i = 0; i < opts.requests; ++i) {
+        std::string query = queries[pick(gen)] + '\n';
+        auto start = std::chrono::steady_clock::now();
+        if (!writeSocketAll(fd, query.data(), query.size())) {
+            result.errors += opts.requests - i;
+            break;
+        }
+
+        bool complete = false;
+        while (readSocketLine(fd, buffer, line)) {
+            if (line.empty()) {
+                complete = true;
+                break;
+            }
+            if (line.find("\terror\t") != std::string::npos || line.find("\"error\":") != std::string::npos) {
+                result.errors++;
+            }
+        }
+        if (!complete) {
+            result.errors += opts.requests - i;
+            break;
+        }
+        result.latencies.push_back(
+            std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    close(fd);
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t idx = static_cast<size_t>(p * (sorted.size() - 1));
+    return sorted[idx];
+}
+
+int main(int argc, char** argv) {
+    LoadOptions opts;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            printLoadgenUsage();
+            return 2;
+        }
+        std::string value = argv[++i];
+        long number = 0;
+        bool numeric = arg == "--clients" || arg == "--requests" || arg == "--seed";
+        if (numeric && !parseNumberArg(value, arg == "--seed" ? 0 : 1, arg == "--seed" ? UINT_MAX : INT_MAX, number)) {
+            std::cerr << "Некорректное значение для " << arg << ": " << value << std::endl;
+            printLoadgenUsage();
+            return 2;
+        }
+        if (arg == "--socket") opts.socketPath = value;
+        else if (arg == "--queries") opts.queriesFile = value;
+        else if (arg == "--clients") opts.clients = static_cast<int>(number);
+        else if (arg == "--requests") opts.requests = static_cast<int>(number);
+        else if (arg == "--seed") opts.seed = static_cast<unsigned>(number);
+        else {
+            printLoadgenUsage();
+            return 2;
+        }
+    }
+
+    std::ifstream in(opts.queriesFile);
+    if (!in) {
+        printLoadgenUsage();
+        return 2;
+    }
+    std::vector<std::string> queries;
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#') continue;
+        queries.push_back(line.substr(start));
+    }
+    if (queries.empty()) {
+        std::cerr << "Файл запросов пуст: " << opts.queriesFile << std::endl;
+        return 2;
+    }
+
+    std::vector<ClientResult> results(opts.clients);
+    std::vector<std::thread> clients;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < opts.clients; ++i) {
+        clients.emplace_back(runClient, std::cref(opts), std::cref(queries), i, std::ref(results[i]));
+    }
+    for (std::thread& client : clients) client.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<double> latencies;
+    long long errors = 0;
+    for (const ClientResult& r : results) {
+        latencies.insert(latencies.end(), r.latencies.begin(), r.latencies.end());
+        errors += r.errors;
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "{\"clients\": " << opts.clients
+              << ", \"requests\": " << latencies.size()
+              << ", \"errors\": " << errors
+              << ", \"seconds\": " << seconds
+              << ", \"qps\": " << (seconds > 0 ? latencies.size() / seconds : 0.0)
+              << ", \"p50_us\": " << percentile(latencies, 0.50)
+              << ", \"p95_us\": " << percentile(latencies, 0.95)
+              << ", \"p99_us\": " << percentile(latencies, 0.99)
+              << ", \"max_us\": " << (latencies.empty() ? 0.0 : latencies.back()) << "}" << std::endl;
+    return errors > 0 ? 1 : 0;
+}